@@ -0,0 +1,734 @@
+// The `beans` Python module: read access to C++ beans and bean tables.
+//
+// C++ code hands objects over as capsules made by beans::python::wrap()
+// (<beans/python.hpp>).  Scalar columns implement the buffer protocol, so
+// numpy.asarray(table.column("price")) and pandas views share the table's
+// storage instead of copying it.  Change notifications are queued on the C++
+// side and delivered to Python callbacks in batches by poll().
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <beans/c/beans.h>
+
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// --- Field metadata --------------------------------------------------------
+
+// struct-module format characters for scalar kinds, indexed by beans_kind.
+const char* const kFormats[] = {"?", "b", "h", "i", "q", "B", "H", "I", "Q", "f", "d"};
+const char* const kKindNames[] = {"bool",   "int8",   "int16", "int32",  "int64",  "uint8", "uint16",
+                                  "uint32", "uint64", "float", "double", "string", "other"};
+
+bool is_scalar(std::uint32_t kind) { return kind <= BEANS_KIND_DOUBLE; }
+
+const char* kind_name(std::uint32_t kind) { return kKindNames[kind <= BEANS_KIND_OTHER ? kind : std::uint32_t{BEANS_KIND_OTHER}]; }
+
+PyObject* to_str(beans_str s) {
+    if (!s.data)
+        return PyUnicode_FromStringAndSize("", 0);
+    return PyUnicode_DecodeUTF8(s.data, static_cast<Py_ssize_t>(s.size), "replace");
+}
+
+std::uint64_t name_hash(std::string_view name) {
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    for (const char c : name) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+// Resolves a field given by name or index; sets an exception and returns -1
+// if there is none.
+Py_ssize_t field_index(const beans_type* type, PyObject* key) {
+    if (PyLong_Check(key)) {
+        const Py_ssize_t i = PyLong_AsSsize_t(key);
+        if (i >= 0 && static_cast<std::size_t>(i) < type->field_count)
+            return i;
+        if (!PyErr_Occurred())
+            PyErr_SetString(PyExc_IndexError, "field index out of range");
+        return -1;
+    }
+    Py_ssize_t len = 0;
+    const char* name = PyUnicode_AsUTF8AndSize(key, &len);
+    if (!name)
+        return -1;
+    const std::string_view wanted(name, static_cast<std::size_t>(len));
+    const std::uint64_t hash = name_hash(wanted);
+    for (std::size_t i = 0; i < type->field_count; ++i) {
+        const beans_field& f = type->fields[i];
+        if (f.hash == hash && std::string_view(f.name.data, f.name.size) == wanted)
+            return static_cast<Py_ssize_t>(i);
+    }
+    PyErr_Format(PyExc_KeyError, "no field '%U' in %s", key, std::string(type->name.data, type->name.size).c_str());
+    return -1;
+}
+
+PyObject* fields_of(const beans_type* type) {
+    PyObject* list = PyList_New(static_cast<Py_ssize_t>(type->field_count));
+    if (!list)
+        return nullptr;
+    for (std::size_t i = 0; i < type->field_count; ++i) {
+        const beans_field& f = type->fields[i];
+        PyObject* item = Py_BuildValue("(s#s)", f.name.data, static_cast<Py_ssize_t>(f.name.size), kind_name(f.kind));
+        if (!item) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, static_cast<Py_ssize_t>(i), item);
+    }
+    return list;
+}
+
+PyObject* scalar_value(std::uint32_t kind, const void* p) {
+    switch (kind) {
+    case BEANS_KIND_BOOL: return PyBool_FromLong(*static_cast<const bool*>(p));
+    case BEANS_KIND_INT8: return PyLong_FromLong(*static_cast<const std::int8_t*>(p));
+    case BEANS_KIND_INT16: return PyLong_FromLong(*static_cast<const std::int16_t*>(p));
+    case BEANS_KIND_INT32: return PyLong_FromLong(*static_cast<const std::int32_t*>(p));
+    case BEANS_KIND_INT64: return PyLong_FromLongLong(*static_cast<const std::int64_t*>(p));
+    case BEANS_KIND_UINT8: return PyLong_FromUnsignedLong(*static_cast<const std::uint8_t*>(p));
+    case BEANS_KIND_UINT16: return PyLong_FromUnsignedLong(*static_cast<const std::uint16_t*>(p));
+    case BEANS_KIND_UINT32: return PyLong_FromUnsignedLong(*static_cast<const std::uint32_t*>(p));
+    case BEANS_KIND_UINT64: return PyLong_FromUnsignedLongLong(*static_cast<const std::uint64_t*>(p));
+    case BEANS_KIND_FLOAT: return PyFloat_FromDouble(*static_cast<const float*>(p));
+    case BEANS_KIND_DOUBLE: return PyFloat_FromDouble(*static_cast<const double*>(p));
+    default: Py_RETURN_NONE;
+    }
+}
+
+// --- Batched notifications -------------------------------------------------
+
+// One Python callback.  The C++ listener only appends to `pending` (under a
+// lock, without the GIL); poll() hands the batch to Python.  The owner's list
+// holds one reference and a poll in progress another, so a callback that
+// unsubscribes does not free a subscription poll() is about to visit.
+struct Subscription {
+    std::uint64_t id = 0;
+    PyObject* callback = nullptr;
+    std::size_t refs = 1;
+    bool live = true;
+    std::mutex mutex;
+    std::vector<beans_change_kind> kinds;
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;  // Table changes.
+    std::vector<std::size_t> fields;                          // Bean changes.
+};
+
+void release(Subscription* s) {
+    if (--s->refs == 0) {
+        Py_XDECREF(s->callback);
+        delete s;
+    }
+}
+
+void queue_table_change(void* user, std::uint32_t kind, std::size_t from, std::size_t to) {
+    auto* s = static_cast<Subscription*>(user);
+    std::lock_guard lock(s->mutex);
+    // Coalesce runs of adjacent changes of the same kind: appends and
+    // updates of consecutive rows arrive as one range.
+    if (!s->kinds.empty() && s->kinds.back() == static_cast<beans_change_kind>(kind) &&
+        kind != BEANS_CHANGE_REMOVED && s->ranges.back().second == from) {
+        s->ranges.back().second = to;
+        return;
+    }
+    s->kinds.push_back(static_cast<beans_change_kind>(kind));
+    s->ranges.emplace_back(from, to);
+}
+
+void queue_bean_change(void* user, std::size_t field) {
+    auto* s = static_cast<Subscription*>(user);
+    std::lock_guard lock(s->mutex);
+    for (const std::size_t f : s->fields)
+        if (f == field)
+            return;
+    s->fields.push_back(field);
+}
+
+const char* const kChangeNames[] = {"inserted", "removed", "replaced"};
+
+// Delivers one subscription's batch; returns the number of changes, or -1
+// with an exception set.
+Py_ssize_t deliver_table(Subscription& s) {
+    std::vector<beans_change_kind> kinds;
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+    {
+        std::lock_guard lock(s.mutex);
+        kinds.swap(s.kinds);
+        ranges.swap(s.ranges);
+    }
+    if (kinds.empty())
+        return 0;
+    PyObject* batch = PyList_New(static_cast<Py_ssize_t>(kinds.size()));
+    if (!batch)
+        return -1;
+    for (std::size_t i = 0; i < kinds.size(); ++i) {
+        PyObject* item = Py_BuildValue("(snn)", kChangeNames[kinds[i]], static_cast<Py_ssize_t>(ranges[i].first),
+                                       static_cast<Py_ssize_t>(ranges[i].second));
+        if (!item) {
+            Py_DECREF(batch);
+            return -1;
+        }
+        PyList_SET_ITEM(batch, static_cast<Py_ssize_t>(i), item);
+    }
+    // The callback may unsubscribe, dropping the subscription's reference.
+    PyObject* callback = s.callback;
+    Py_INCREF(callback);
+    PyObject* result = PyObject_CallOneArg(callback, batch);
+    Py_DECREF(callback);
+    Py_DECREF(batch);
+    if (!result)
+        return -1;
+    Py_DECREF(result);
+    return static_cast<Py_ssize_t>(kinds.size());
+}
+
+Py_ssize_t deliver_bean(Subscription& s, const beans_type* type) {
+    std::vector<std::size_t> fields;
+    {
+        std::lock_guard lock(s.mutex);
+        fields.swap(s.fields);
+    }
+    if (fields.empty())
+        return 0;
+    PyObject* names = PyList_New(static_cast<Py_ssize_t>(fields.size()));
+    if (!names)
+        return -1;
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+        const beans_str name = type->fields[fields[i]].name;
+        PyObject* item = PyUnicode_FromStringAndSize(name.data, static_cast<Py_ssize_t>(name.size));
+        if (!item) {
+            Py_DECREF(names);
+            return -1;
+        }
+        PyList_SET_ITEM(names, static_cast<Py_ssize_t>(i), item);
+    }
+    PyObject* callback = s.callback;
+    Py_INCREF(callback);
+    PyObject* result = PyObject_CallOneArg(callback, names);
+    Py_DECREF(callback);
+    Py_DECREF(names);
+    if (!result)
+        return -1;
+    Py_DECREF(result);
+    return static_cast<Py_ssize_t>(fields.size());
+}
+
+// Calls `deliver(subscription)` for each subscription, over a copy of the
+// list as callbacks may subscribe and unsubscribe; returns the number of
+// changes delivered, or nullptr with an exception set.
+template <class F>
+PyObject* poll_subscriptions(const std::vector<Subscription*>& subscriptions, F deliver) {
+    const std::vector<Subscription*> snapshot = subscriptions;
+    for (Subscription* s : snapshot)
+        ++s->refs;
+    Py_ssize_t total = 0;
+    bool failed = false;
+    for (Subscription* s : snapshot) {
+        if (failed || !s->live)
+            continue;
+        const Py_ssize_t n = deliver(*s);
+        if (n < 0)
+            failed = true;
+        else
+            total += n;
+    }
+    for (Subscription* s : snapshot)
+        release(s);
+    return failed ? nullptr : PyLong_FromSsize_t(total);
+}
+
+// --- Table -----------------------------------------------------------------
+
+struct TableObject {
+    PyObject_HEAD
+    beans_table handle;
+    std::vector<Subscription*>* subscriptions;
+};
+
+// Created from the specs below by PyInit_beans.
+PyTypeObject* ColumnType = nullptr;
+
+struct ColumnObject {
+    PyObject_HEAD
+    TableObject* table;  // Strong reference.
+    std::size_t field;
+};
+
+PyObject* Table_new(PyTypeObject* type, PyObject* args, PyObject*) {
+    PyObject* capsule = nullptr;
+    if (!PyArg_ParseTuple(args, "O", &capsule))
+        return nullptr;
+    auto* handle = static_cast<beans_table*>(PyCapsule_GetPointer(capsule, "beans.table"));
+    if (!handle)
+        return nullptr;
+    if (handle->abi_version < BEANS_ABI_VERSION) {
+        PyErr_SetString(PyExc_ValueError, "beans table handle built for an older ABI");
+        return nullptr;
+    }
+    auto* self = reinterpret_cast<TableObject*>(type->tp_alloc(type, 0));
+    if (!self)
+        return nullptr;
+    self->handle = *handle;
+    self->subscriptions = new (std::nothrow) std::vector<Subscription*>();
+    if (!self->subscriptions) {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+    return reinterpret_cast<PyObject*>(self);
+}
+
+void Table_dealloc(TableObject* self) {
+    if (self->subscriptions) {
+        for (Subscription* s : *self->subscriptions) {
+            self->handle.unsubscribe(self->handle.self, s->id);
+            release(s);
+        }
+        delete self->subscriptions;
+    }
+    PyTypeObject* type = Py_TYPE(self);
+    type->tp_free(reinterpret_cast<PyObject*>(self));
+    Py_DECREF(type);
+}
+
+Py_ssize_t Table_len(TableObject* self) {
+    return static_cast<Py_ssize_t>(self->handle.size(self->handle.self));
+}
+
+PyObject* Table_column(TableObject* self, PyObject* key) {
+    const Py_ssize_t field = field_index(self->handle.type, key);
+    if (field < 0)
+        return nullptr;
+    const beans_field& f = self->handle.type->fields[field];
+    if (is_scalar(f.kind)) {
+        auto* column = PyObject_New(ColumnObject, ColumnType);
+        if (!column)
+            return nullptr;
+        Py_INCREF(self);
+        column->table = self;
+        column->field = static_cast<std::size_t>(field);
+        return reinterpret_cast<PyObject*>(column);
+    }
+    if (f.kind != BEANS_KIND_STRING) {
+        PyErr_Format(PyExc_TypeError, "field '%s' has no Python representation",
+                     std::string(f.name.data, f.name.size).c_str());
+        return nullptr;
+    }
+    const std::size_t n = self->handle.size(self->handle.self);
+    PyObject* list = PyList_New(static_cast<Py_ssize_t>(n));
+    if (!list)
+        return nullptr;
+    for (std::size_t row = 0; row < n; ++row) {
+        PyObject* s = to_str(self->handle.string(self->handle.self, static_cast<std::size_t>(field), row));
+        if (!s) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, static_cast<Py_ssize_t>(row), s);
+    }
+    return list;
+}
+
+PyObject* Table_row(TableObject* self, PyObject* arg) {
+    const Py_ssize_t row = PyLong_AsSsize_t(arg);
+    if (row < 0 && PyErr_Occurred())
+        return nullptr;
+    const std::size_t n = self->handle.size(self->handle.self);
+    if (row < 0 || static_cast<std::size_t>(row) >= n) {
+        PyErr_SetString(PyExc_IndexError, "row out of range");
+        return nullptr;
+    }
+    PyObject* dict = PyDict_New();
+    if (!dict)
+        return nullptr;
+    const beans_type* type = self->handle.type;
+    for (std::size_t i = 0; i < type->field_count; ++i) {
+        const beans_field& f = type->fields[i];
+        PyObject* value = nullptr;
+        if (is_scalar(f.kind)) {
+            const auto* base = static_cast<const char*>(self->handle.column(self->handle.self, i));
+            value = scalar_value(f.kind, base + static_cast<std::size_t>(row) * f.size);
+        } else if (f.kind == BEANS_KIND_STRING) {
+            value = to_str(self->handle.string(self->handle.self, i, static_cast<std::size_t>(row)));
+        } else {
+            continue;
+        }
+        PyObject* key = PyUnicode_FromStringAndSize(f.name.data, static_cast<Py_ssize_t>(f.name.size));
+        const int rc = value && key ? PyDict_SetItem(dict, key, value) : -1;
+        Py_XDECREF(key);
+        Py_XDECREF(value);
+        if (rc < 0) {
+            Py_DECREF(dict);
+            return nullptr;
+        }
+    }
+    return dict;
+}
+
+PyObject* Table_columns(TableObject* self, PyObject*) {
+    PyObject* dict = PyDict_New();
+    if (!dict)
+        return nullptr;
+    const beans_type* type = self->handle.type;
+    for (std::size_t i = 0; i < type->field_count; ++i) {
+        const beans_field& f = type->fields[i];
+        if (!is_scalar(f.kind) && f.kind != BEANS_KIND_STRING)
+            continue;
+        PyObject* index = PyLong_FromSize_t(i);
+        PyObject* column = index ? Table_column(self, index) : nullptr;
+        Py_XDECREF(index);
+        PyObject* key = PyUnicode_FromStringAndSize(f.name.data, static_cast<Py_ssize_t>(f.name.size));
+        const int rc = column && key ? PyDict_SetItem(dict, key, column) : -1;
+        Py_XDECREF(key);
+        Py_XDECREF(column);
+        if (rc < 0) {
+            Py_DECREF(dict);
+            return nullptr;
+        }
+    }
+    return dict;
+}
+
+PyObject* Table_subscribe(TableObject* self, PyObject* callback) {
+    if (!PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "callback must be callable");
+        return nullptr;
+    }
+    auto* s = new (std::nothrow) Subscription();
+    if (!s)
+        return PyErr_NoMemory();
+    s->id = self->handle.subscribe(self->handle.self, &queue_table_change, s);
+    if (!s->id) {
+        delete s;
+        return PyErr_NoMemory();
+    }
+    Py_INCREF(callback);
+    s->callback = callback;
+    self->subscriptions->push_back(s);
+    return PyLong_FromUnsignedLongLong(s->id);
+}
+
+PyObject* unsubscribe_from(std::vector<Subscription*>& subscriptions, PyObject* arg, void* owner,
+                           int (*unsubscribe)(void*, std::uint64_t)) {
+    const unsigned long long id = PyLong_AsUnsignedLongLong(arg);
+    if (PyErr_Occurred())
+        return nullptr;
+    for (auto it = subscriptions.begin(); it != subscriptions.end(); ++it) {
+        if ((*it)->id == id) {
+            unsubscribe(owner, id);
+            Subscription* s = *it;
+            subscriptions.erase(it);
+            s->live = false;
+            release(s);
+            Py_RETURN_TRUE;
+        }
+    }
+    Py_RETURN_FALSE;
+}
+
+PyObject* Table_unsubscribe(TableObject* self, PyObject* arg) {
+    return unsubscribe_from(*self->subscriptions, arg, self->handle.self, self->handle.unsubscribe);
+}
+
+PyObject* Table_poll(TableObject* self, PyObject*) {
+    return poll_subscriptions(*self->subscriptions, [](Subscription& s) { return deliver_table(s); });
+}
+
+PyObject* Table_get_fields(TableObject* self, void*) { return fields_of(self->handle.type); }
+
+PyObject* Table_get_name(TableObject* self, void*) { return to_str(self->handle.type->name); }
+
+PyMethodDef Table_methods[] = {
+    {"column", reinterpret_cast<PyCFunction>(Table_column), METH_O,
+     "column(field) -> buffer of a scalar column (zero-copy), or list of str"},
+    {"columns", reinterpret_cast<PyCFunction>(Table_columns), METH_NOARGS,
+     "columns() -> {name: column}, e.g. for pandas.DataFrame(table.columns())"},
+    {"row", reinterpret_cast<PyCFunction>(Table_row), METH_O, "row(index) -> dict"},
+    {"subscribe", reinterpret_cast<PyCFunction>(Table_subscribe), METH_O,
+     "subscribe(callback) -> id; poll() calls callback([(kind, from, to), ...])"},
+    {"unsubscribe", reinterpret_cast<PyCFunction>(Table_unsubscribe), METH_O, "unsubscribe(id) -> bool"},
+    {"poll", reinterpret_cast<PyCFunction>(Table_poll), METH_NOARGS,
+     "poll() -> number of changes delivered to callbacks"},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyGetSetDef Table_getset[] = {
+    {"fields", reinterpret_cast<getter>(Table_get_fields), nullptr, "[(name, kind), ...]", nullptr},
+    {"name", reinterpret_cast<getter>(Table_get_name), nullptr, "bean type name", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+PyType_Slot Table_slots[] = {
+    {Py_tp_dealloc, reinterpret_cast<void*>(Table_dealloc)},
+    {Py_sq_length, reinterpret_cast<void*>(Table_len)},
+    {Py_tp_doc, const_cast<char*>("Table(capsule): a C++ beans::BeanTable, from beans::python::wrap(table)")},
+    {Py_tp_methods, Table_methods},
+    {Py_tp_getset, Table_getset},
+    {Py_tp_new, reinterpret_cast<void*>(Table_new)},
+    {0, nullptr},
+};
+
+PyType_Spec Table_spec = {"beans.Table", sizeof(TableObject), 0, Py_TPFLAGS_DEFAULT, Table_slots};
+
+// --- Column ----------------------------------------------------------------
+
+void Column_dealloc(ColumnObject* self) {
+    PyTypeObject* type = Py_TYPE(self);
+    Py_XDECREF(self->table);
+    PyObject_Free(self);
+    Py_DECREF(type);
+}
+
+Py_ssize_t Column_len(ColumnObject* self) { return Table_len(self->table); }
+
+// Exposes the column in place.  The buffer is valid until the C++ table is
+// next modified; copy it (numpy.array(column)) to keep the values.
+int Column_getbuffer(ColumnObject* self, Py_buffer* view, int flags) {
+    if (flags & PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "bean table columns are read-only");
+        return -1;
+    }
+    const beans_table& h = self->table->handle;
+    const beans_field& f = h.type->fields[self->field];
+    const std::size_t n = h.size(h.self);
+    const void* data = h.column(h.self, self->field);
+    static const char empty = 0;
+    view->obj = reinterpret_cast<PyObject*>(self);
+    Py_INCREF(self);
+    view->buf = const_cast<void*>(data ? data : &empty);
+    view->len = static_cast<Py_ssize_t>(n * f.size);
+    view->readonly = 1;
+    view->itemsize = static_cast<Py_ssize_t>(f.size);
+    view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>(kFormats[f.kind]) : nullptr;
+    view->ndim = 1;
+    // shape and strides live in `internal` so each view owns its own.
+    auto* dims = new (std::nothrow) Py_ssize_t[2]{static_cast<Py_ssize_t>(n), static_cast<Py_ssize_t>(f.size)};
+    if (!dims) {
+        Py_DECREF(self);
+        view->obj = nullptr;
+        PyErr_NoMemory();
+        return -1;
+    }
+    view->internal = dims;
+    view->shape = (flags & PyBUF_ND) == PyBUF_ND ? &dims[0] : nullptr;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &dims[1] : nullptr;
+    view->suboffsets = nullptr;
+    return 0;
+}
+
+void Column_releasebuffer(ColumnObject*, Py_buffer* view) { delete[] static_cast<Py_ssize_t*>(view->internal); }
+
+PyType_Slot Column_slots[] = {
+    {Py_tp_dealloc, reinterpret_cast<void*>(Column_dealloc)},
+    {Py_sq_length, reinterpret_cast<void*>(Column_len)},
+    {Py_bf_getbuffer, reinterpret_cast<void*>(Column_getbuffer)},
+    {Py_bf_releasebuffer, reinterpret_cast<void*>(Column_releasebuffer)},
+    {Py_tp_doc, const_cast<char*>("A scalar column of a beans.Table, exposed through the buffer protocol")},
+    {0, nullptr},
+};
+
+PyType_Spec Column_spec = {"beans.Column", sizeof(ColumnObject), 0, Py_TPFLAGS_DEFAULT, Column_slots};
+
+// --- Bean ------------------------------------------------------------------
+
+struct BeanObject {
+    PyObject_HEAD
+    beans_bean handle;
+    std::vector<Subscription*>* subscriptions;
+};
+
+PyObject* Bean_new(PyTypeObject* type, PyObject* args, PyObject*) {
+    PyObject* capsule = nullptr;
+    if (!PyArg_ParseTuple(args, "O", &capsule))
+        return nullptr;
+    auto* handle = static_cast<beans_bean*>(PyCapsule_GetPointer(capsule, "beans.bean"));
+    if (!handle)
+        return nullptr;
+    if (handle->abi_version < BEANS_ABI_VERSION) {
+        PyErr_SetString(PyExc_ValueError, "beans bean handle built for an older ABI");
+        return nullptr;
+    }
+    auto* self = reinterpret_cast<BeanObject*>(type->tp_alloc(type, 0));
+    if (!self)
+        return nullptr;
+    self->handle = *handle;
+    self->subscriptions = new (std::nothrow) std::vector<Subscription*>();
+    if (!self->subscriptions) {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+    return reinterpret_cast<PyObject*>(self);
+}
+
+void Bean_dealloc(BeanObject* self) {
+    if (self->subscriptions) {
+        for (Subscription* s : *self->subscriptions) {
+            self->handle.unsubscribe(self->handle.self, s->id);
+            release(s);
+        }
+        delete self->subscriptions;
+    }
+    PyTypeObject* type = Py_TYPE(self);
+    type->tp_free(reinterpret_cast<PyObject*>(self));
+    Py_DECREF(type);
+}
+
+PyObject* bean_field(BeanObject* self, std::size_t i) {
+    const beans_field& f = self->handle.type->fields[i];
+    if (is_scalar(f.kind))
+        return scalar_value(f.kind, self->handle.field(self->handle.self, i));
+    if (f.kind == BEANS_KIND_STRING)
+        return to_str(self->handle.string(self->handle.self, i));
+    Py_RETURN_NONE;
+}
+
+PyObject* Bean_getitem(BeanObject* self, PyObject* key) {
+    const Py_ssize_t i = field_index(self->handle.type, key);
+    return i < 0 ? nullptr : bean_field(self, static_cast<std::size_t>(i));
+}
+
+PyObject* Bean_getattro(BeanObject* self, PyObject* name) {
+    if (PyObject* attr = PyObject_GenericGetAttr(reinterpret_cast<PyObject*>(self), name))
+        return attr;
+    if (!PyErr_ExceptionMatches(PyExc_AttributeError))
+        return nullptr;
+    PyErr_Clear();
+    const Py_ssize_t i = field_index(self->handle.type, name);
+    if (i < 0) {
+        PyErr_Clear();
+        PyErr_SetObject(PyExc_AttributeError, name);
+        return nullptr;
+    }
+    return bean_field(self, static_cast<std::size_t>(i));
+}
+
+Py_ssize_t Bean_len(BeanObject* self) { return static_cast<Py_ssize_t>(self->handle.type->field_count); }
+
+PyObject* Bean_to_dict(BeanObject* self, PyObject*) {
+    PyObject* dict = PyDict_New();
+    if (!dict)
+        return nullptr;
+    const beans_type* type = self->handle.type;
+    for (std::size_t i = 0; i < type->field_count; ++i) {
+        const beans_field& f = type->fields[i];
+        PyObject* key = PyUnicode_FromStringAndSize(f.name.data, static_cast<Py_ssize_t>(f.name.size));
+        PyObject* value = bean_field(self, i);
+        const int rc = key && value ? PyDict_SetItem(dict, key, value) : -1;
+        Py_XDECREF(key);
+        Py_XDECREF(value);
+        if (rc < 0) {
+            Py_DECREF(dict);
+            return nullptr;
+        }
+    }
+    return dict;
+}
+
+PyObject* Bean_subscribe(BeanObject* self, PyObject* callback) {
+    if (!self->handle.subscribe) {
+        PyErr_SetString(PyExc_TypeError, "this bean type does not report changes");
+        return nullptr;
+    }
+    if (!PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "callback must be callable");
+        return nullptr;
+    }
+    auto* s = new (std::nothrow) Subscription();
+    if (!s)
+        return PyErr_NoMemory();
+    s->id = self->handle.subscribe(self->handle.self, &queue_bean_change, s);
+    if (!s->id) {
+        delete s;
+        return PyErr_NoMemory();
+    }
+    Py_INCREF(callback);
+    s->callback = callback;
+    self->subscriptions->push_back(s);
+    return PyLong_FromUnsignedLongLong(s->id);
+}
+
+PyObject* Bean_unsubscribe(BeanObject* self, PyObject* arg) {
+    if (!self->handle.unsubscribe)
+        Py_RETURN_FALSE;
+    return unsubscribe_from(*self->subscriptions, arg, self->handle.self, self->handle.unsubscribe);
+}
+
+PyObject* Bean_poll(BeanObject* self, PyObject*) {
+    const beans_type* type = self->handle.type;
+    return poll_subscriptions(*self->subscriptions, [type](Subscription& s) { return deliver_bean(s, type); });
+}
+
+PyObject* Bean_get_fields(BeanObject* self, void*) { return fields_of(self->handle.type); }
+
+PyObject* Bean_get_type_name(BeanObject* self, void*) { return to_str(self->handle.type->name); }
+
+PyMethodDef Bean_methods[] = {
+    {"to_dict", reinterpret_cast<PyCFunction>(Bean_to_dict), METH_NOARGS, "to_dict() -> {name: value}"},
+    {"subscribe", reinterpret_cast<PyCFunction>(Bean_subscribe), METH_O,
+     "subscribe(callback) -> id; poll() calls callback([changed field names])"},
+    {"unsubscribe", reinterpret_cast<PyCFunction>(Bean_unsubscribe), METH_O, "unsubscribe(id) -> bool"},
+    {"poll", reinterpret_cast<PyCFunction>(Bean_poll), METH_NOARGS,
+     "poll() -> number of field changes delivered to callbacks"},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyGetSetDef Bean_getset[] = {
+    {"fields", reinterpret_cast<getter>(Bean_get_fields), nullptr, "[(name, kind), ...]", nullptr},
+    {"type_name", reinterpret_cast<getter>(Bean_get_type_name), nullptr, "bean type name", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+PyType_Slot Bean_slots[] = {
+    {Py_tp_dealloc, reinterpret_cast<void*>(Bean_dealloc)},
+    {Py_mp_length, reinterpret_cast<void*>(Bean_len)},
+    {Py_mp_subscript, reinterpret_cast<void*>(Bean_getitem)},
+    {Py_tp_getattro, reinterpret_cast<void*>(Bean_getattro)},
+    {Py_tp_doc, const_cast<char*>("Bean(capsule): a C++ bean, from beans::python::wrap(bean)")},
+    {Py_tp_methods, Bean_methods},
+    {Py_tp_getset, Bean_getset},
+    {Py_tp_new, reinterpret_cast<void*>(Bean_new)},
+    {0, nullptr},
+};
+
+PyType_Spec Bean_spec = {"beans.Bean", sizeof(BeanObject), 0, Py_TPFLAGS_DEFAULT, Bean_slots};
+
+PyModuleDef module = {
+    .m_base = PyModuleDef_HEAD_INIT,
+    .m_name = "beans",
+    .m_doc = "Zero-copy access to C++ beans and bean tables.",
+    .m_size = -1,
+    .m_methods = nullptr,
+    .m_slots = nullptr,
+    .m_traverse = nullptr,
+    .m_clear = nullptr,
+    .m_free = nullptr,
+};
+
+}  // namespace
+
+PyMODINIT_FUNC PyInit_beans() {
+    PyObject* m = PyModule_Create(&module);
+    if (!m)
+        return nullptr;
+    ColumnType = reinterpret_cast<PyTypeObject*>(PyType_FromSpec(&Column_spec));
+    PyObject* table = PyType_FromSpec(&Table_spec);
+    PyObject* bean = PyType_FromSpec(&Bean_spec);
+    const bool ok = ColumnType && table && bean && PyModule_AddObjectRef(m, "Table", table) == 0 &&
+                    PyModule_AddObjectRef(m, "Bean", bean) == 0;
+    Py_XDECREF(table);
+    Py_XDECREF(bean);
+    if (!ok) {
+        Py_DECREF(m);
+        return nullptr;
+    }
+    return m;
+}
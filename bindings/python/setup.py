@@ -0,0 +1,22 @@
+"""Builds the `beans` extension module: pip install ./bindings/python"""
+
+import os
+
+from setuptools import Extension, setup
+
+here = os.path.dirname(os.path.abspath(__file__))
+
+setup(
+    name="beans",
+    version="0.1.0",
+    description="Zero-copy access to C++ beans and bean tables",
+    ext_modules=[
+        Extension(
+            "beans",
+            sources=[os.path.join(here, "beans_module.cpp")],
+            include_dirs=[os.path.join(here, "..", "..", "include")],
+            extra_compile_args=["-std=c++20"],
+            language="c++",
+        )
+    ],
+)
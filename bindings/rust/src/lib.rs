@@ -0,0 +1,411 @@
+//! Zero-copy access to C++ beans and bean tables.
+//!
+//! The C++ side describes a bean or a `beans::BeanTable` with
+//! `beans::c::export_bean()` / `beans::c::export_table()` (see
+//! `include/beans/c_api.hpp`) and hands the resulting `beans_bean` /
+//! `beans_table` struct to Rust.  The ABI is a struct of function pointers,
+//! so this crate links against nothing.
+//!
+//! Scalar columns are borrowed as slices of the table's own storage and
+//! strings as `&str` views of the C++ strings; nothing is copied.
+//!
+//! ```ignore
+//! let table = unsafe { beans::Table::from_raw(ptr) }.expect("ABI mismatch");
+//! let price = table.field_index("price").unwrap();
+//! let total: f64 = table.column::<f64>(price).unwrap().iter().sum();
+//! ```
+
+use std::ffi::c_void;
+use std::marker::PhantomData;
+
+/// Raw declarations mirroring `include/beans/c/beans.h`.
+#[allow(non_camel_case_types)]
+pub mod sys {
+    use std::ffi::{c_char, c_int, c_void};
+
+    pub const BEANS_ABI_VERSION: u32 = 1;
+
+    #[repr(C)]
+    #[derive(Clone, Copy)]
+    pub struct beans_str {
+        pub data: *const c_char,
+        pub size: usize,
+    }
+
+    #[repr(C)]
+    pub struct beans_field {
+        pub name: beans_str,
+        pub hash: u64,
+        pub kind: u32,
+        pub size: u32,
+    }
+
+    #[repr(C)]
+    pub struct beans_type {
+        pub name: beans_str,
+        pub fields: *const beans_field,
+        pub field_count: usize,
+    }
+
+    pub type beans_bean_listener = unsafe extern "C" fn(user: *mut c_void, field: usize);
+    pub type beans_table_listener =
+        unsafe extern "C" fn(user: *mut c_void, change_kind: u32, from: usize, to: usize);
+
+    #[repr(C)]
+    pub struct beans_bean {
+        pub abi_version: u32,
+        pub type_: *const beans_type,
+        pub self_: *mut c_void,
+        pub field: unsafe extern "C" fn(*const c_void, usize) -> *const c_void,
+        pub string: unsafe extern "C" fn(*const c_void, usize) -> beans_str,
+        pub subscribe:
+            Option<unsafe extern "C" fn(*mut c_void, beans_bean_listener, *mut c_void) -> u64>,
+        pub unsubscribe: Option<unsafe extern "C" fn(*mut c_void, u64) -> c_int>,
+    }
+
+    #[repr(C)]
+    pub struct beans_table {
+        pub abi_version: u32,
+        pub type_: *const beans_type,
+        pub self_: *mut c_void,
+        pub size: unsafe extern "C" fn(*const c_void) -> usize,
+        pub column: unsafe extern "C" fn(*const c_void, usize) -> *const c_void,
+        pub string: unsafe extern "C" fn(*const c_void, usize, usize) -> beans_str,
+        pub subscribe: unsafe extern "C" fn(*mut c_void, beans_table_listener, *mut c_void) -> u64,
+        pub unsubscribe: unsafe extern "C" fn(*mut c_void, u64) -> c_int,
+    }
+}
+
+/// Runtime category of a field; mirrors `beans::FieldKind`.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum Kind {
+    Bool,
+    Int8,
+    Int16,
+    Int32,
+    Int64,
+    UInt8,
+    UInt16,
+    UInt32,
+    UInt64,
+    Float,
+    Double,
+    String,
+    Other,
+}
+
+impl Kind {
+    fn from_raw(kind: u32) -> Kind {
+        match kind {
+            0 => Kind::Bool,
+            1 => Kind::Int8,
+            2 => Kind::Int16,
+            3 => Kind::Int32,
+            4 => Kind::Int64,
+            5 => Kind::UInt8,
+            6 => Kind::UInt16,
+            7 => Kind::UInt32,
+            8 => Kind::UInt64,
+            9 => Kind::Float,
+            10 => Kind::Double,
+            11 => Kind::String,
+            _ => Kind::Other,
+        }
+    }
+}
+
+mod sealed {
+    pub trait Sealed {}
+}
+
+/// Rust types that share their representation with a scalar field kind.
+pub trait Scalar: Copy + sealed::Sealed {
+    const KIND: Kind;
+}
+
+macro_rules! scalar {
+    ($($t:ty => $kind:ident),* $(,)?) => {$(
+        impl sealed::Sealed for $t {}
+        impl Scalar for $t {
+            const KIND: Kind = Kind::$kind;
+        }
+    )*};
+}
+
+scalar! {
+    bool => Bool, i8 => Int8, i16 => Int16, i32 => Int32, i64 => Int64,
+    u8 => UInt8, u16 => UInt16, u32 => UInt32, u64 => UInt64, f32 => Float, f64 => Double,
+}
+
+/// One field of a bean type.
+#[derive(Clone, Copy, Debug)]
+pub struct Field<'a> {
+    pub name: &'a str,
+    pub hash: u64,
+    pub kind: Kind,
+    pub size: usize,
+}
+
+/// A bean type: its name and fields in declaration order.
+#[derive(Clone, Copy)]
+pub struct BeanType<'a> {
+    raw: &'a sys::beans_type,
+}
+
+impl<'a> BeanType<'a> {
+    pub fn name(&self) -> &'a str {
+        unsafe { as_str(self.raw.name) }.unwrap_or("")
+    }
+
+    pub fn len(&self) -> usize {
+        self.raw.field_count
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.raw.field_count == 0
+    }
+
+    pub fn field(&self, index: usize) -> Option<Field<'a>> {
+        if index >= self.raw.field_count {
+            return None;
+        }
+        let f = unsafe { &*self.raw.fields.add(index) };
+        Some(Field {
+            name: unsafe { as_str(f.name) }.unwrap_or(""),
+            hash: f.hash,
+            kind: Kind::from_raw(f.kind),
+            size: f.size as usize,
+        })
+    }
+
+    pub fn fields(&self) -> impl Iterator<Item = Field<'a>> + 'a {
+        let this = *self;
+        (0..this.len()).filter_map(move |i| this.field(i))
+    }
+
+    /// Index of the field called `name`.
+    pub fn index_of(&self, name: &str) -> Option<usize> {
+        let hash = name_hash(name);
+        self.fields().position(|f| f.hash == hash && f.name == name)
+    }
+}
+
+/// 64-bit FNV-1a, the hash the C++ side stores with every field name.
+pub fn name_hash(name: &str) -> u64 {
+    name.bytes().fold(0xcbf2_9ce4_8422_2325, |h, b| {
+        (h ^ b as u64).wrapping_mul(0x100_0000_01b3)
+    })
+}
+
+/// A change to a table: rows `from..to` were inserted, removed (indices as
+/// they were before removal) or replaced.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum Change {
+    Inserted { from: usize, to: usize },
+    Removed { from: usize, to: usize },
+    Replaced { from: usize, to: usize },
+}
+
+/// A `beans::BeanTable` exported by C++.
+pub struct Table<'a> {
+    raw: &'a sys::beans_table,
+}
+
+impl<'a> Table<'a> {
+    /// Wraps a handle produced by `beans::c::export_table()`.  Returns `None`
+    /// if the handle is null or was built for an older ABI.
+    ///
+    /// # Safety
+    ///
+    /// The handle and the C++ table must outlive `'a`, and the table must not
+    /// be modified while slices or strings borrowed from it are alive.
+    pub unsafe fn from_raw(raw: *const sys::beans_table) -> Option<Table<'a>> {
+        let raw = raw.as_ref()?;
+        (raw.abi_version >= sys::BEANS_ABI_VERSION).then_some(Table { raw })
+    }
+
+    pub fn bean_type(&self) -> BeanType<'a> {
+        BeanType {
+            raw: unsafe { &*self.raw.type_ },
+        }
+    }
+
+    pub fn field_index(&self, name: &str) -> Option<usize> {
+        self.bean_type().index_of(name)
+    }
+
+    pub fn len(&self) -> usize {
+        unsafe { (self.raw.size)(self.raw.self_) }
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// The table's column `field`, borrowed in place.  `None` if the field
+    /// does not exist or its kind is not `T`'s.
+    pub fn column<T: Scalar>(&self, field: usize) -> Option<&[T]> {
+        if self.bean_type().field(field)?.kind != T::KIND {
+            return None;
+        }
+        let len = self.len();
+        let data = unsafe { (self.raw.column)(self.raw.self_, field) } as *const T;
+        if data.is_null() {
+            return Some(&[]);
+        }
+        Some(unsafe { std::slice::from_raw_parts(data, len) })
+    }
+
+    /// The string in `field` at `row`; `None` for non-string fields, rows
+    /// out of range and strings that are not UTF-8.
+    pub fn string(&self, field: usize, row: usize) -> Option<&str> {
+        if row >= self.len() {
+            return None;
+        }
+        unsafe { as_str((self.raw.string)(self.raw.self_, field, row)) }
+    }
+
+    /// Calls `listener` for every change made through the table's mutators
+    /// until the returned subscription is dropped.
+    pub fn subscribe<F: FnMut(Change) + 'a>(&self, listener: F) -> Option<Subscription<'a>> {
+        unsafe extern "C" fn trampoline(user: *mut c_void, kind: u32, from: usize, to: usize) {
+            let listener = &mut *(user as *mut Box<dyn FnMut(Change)>);
+            listener(match kind {
+                0 => Change::Inserted { from, to },
+                1 => Change::Removed { from, to },
+                _ => Change::Replaced { from, to },
+            });
+        }
+        let boxed: Box<Box<dyn FnMut(Change) + 'a>> = Box::new(Box::new(listener));
+        let user = Box::into_raw(boxed) as *mut c_void;
+        let id = unsafe { (self.raw.subscribe)(self.raw.self_, trampoline, user) };
+        Subscription::new(
+            self.raw.self_,
+            Some(self.raw.unsubscribe),
+            id,
+            user,
+            drop_listener::<Change>,
+        )
+    }
+}
+
+/// One bean exported by C++.
+pub struct Bean<'a> {
+    raw: &'a sys::beans_bean,
+}
+
+impl<'a> Bean<'a> {
+    /// Wraps a handle produced by `beans::c::export_bean()`.  Returns `None`
+    /// if the handle is null or was built for an older ABI.
+    ///
+    /// # Safety
+    ///
+    /// The handle and the C++ bean must outlive `'a`, and the bean must not
+    /// be modified while references borrowed from it are alive.
+    pub unsafe fn from_raw(raw: *const sys::beans_bean) -> Option<Bean<'a>> {
+        let raw = raw.as_ref()?;
+        (raw.abi_version >= sys::BEANS_ABI_VERSION).then_some(Bean { raw })
+    }
+
+    pub fn bean_type(&self) -> BeanType<'a> {
+        BeanType {
+            raw: unsafe { &*self.raw.type_ },
+        }
+    }
+
+    pub fn field_index(&self, name: &str) -> Option<usize> {
+        self.bean_type().index_of(name)
+    }
+
+    /// The scalar `field`, borrowed in place.  `None` if the field does not
+    /// exist or its kind is not `T`'s.
+    pub fn get<T: Scalar>(&self, field: usize) -> Option<&T> {
+        if self.bean_type().field(field)?.kind != T::KIND {
+            return None;
+        }
+        unsafe { ((self.raw.field)(self.raw.self_, field) as *const T).as_ref() }
+    }
+
+    /// The string `field`; `None` for other kinds and non-UTF-8 strings.
+    pub fn string(&self, field: usize) -> Option<&str> {
+        self.bean_type().field(field)?;
+        unsafe { as_str((self.raw.string)(self.raw.self_, field)) }
+    }
+
+    /// Calls `listener` with the index of each field that changes until the
+    /// returned subscription is dropped.  `None` if the bean type does not
+    /// report changes.
+    pub fn subscribe<F: FnMut(usize) + 'a>(&self, listener: F) -> Option<Subscription<'a>> {
+        unsafe extern "C" fn trampoline(user: *mut c_void, field: usize) {
+            let listener = &mut *(user as *mut Box<dyn FnMut(usize)>);
+            listener(field);
+        }
+        let subscribe = self.raw.subscribe?;
+        let boxed: Box<Box<dyn FnMut(usize) + 'a>> = Box::new(Box::new(listener));
+        let user = Box::into_raw(boxed) as *mut c_void;
+        let id = unsafe { subscribe(self.raw.self_, trampoline, user) };
+        Subscription::new(
+            self.raw.self_,
+            self.raw.unsubscribe,
+            id,
+            user,
+            drop_listener::<usize>,
+        )
+    }
+}
+
+/// Keeps a listener registered; dropping it unsubscribes and frees the
+/// closure.
+pub struct Subscription<'a> {
+    self_: *mut c_void,
+    unsubscribe: Option<unsafe extern "C" fn(*mut c_void, u64) -> std::ffi::c_int>,
+    id: u64,
+    user: *mut c_void,
+    drop_user: unsafe fn(*mut c_void),
+    _owner: PhantomData<&'a ()>,
+}
+
+impl<'a> Subscription<'a> {
+    fn new(
+        self_: *mut c_void,
+        unsubscribe: Option<unsafe extern "C" fn(*mut c_void, u64) -> std::ffi::c_int>,
+        id: u64,
+        user: *mut c_void,
+        drop_user: unsafe fn(*mut c_void),
+    ) -> Option<Subscription<'a>> {
+        if id == 0 {
+            unsafe { drop_user(user) };
+            return None;
+        }
+        Some(Subscription {
+            self_,
+            unsubscribe,
+            id,
+            user,
+            drop_user,
+            _owner: PhantomData,
+        })
+    }
+}
+
+impl Drop for Subscription<'_> {
+    fn drop(&mut self) {
+        unsafe {
+            if let Some(unsubscribe) = self.unsubscribe {
+                unsubscribe(self.self_, self.id);
+            }
+            (self.drop_user)(self.user);
+        }
+    }
+}
+
+unsafe fn drop_listener<A>(user: *mut c_void) {
+    drop(Box::from_raw(user as *mut Box<dyn FnMut(A)>));
+}
+
+unsafe fn as_str<'a>(s: sys::beans_str) -> Option<&'a str> {
+    if s.data.is_null() {
+        return None;
+    }
+    std::str::from_utf8(std::slice::from_raw_parts(s.data as *const u8, s.size)).ok()
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bean_table.hpp"
+#include "c/arrow.h"
+#include "descriptor.hpp"
+#include "reflect.hpp"
+
+namespace beans::arrow {
+
+namespace detail {
+
+/// Arrow format string of a field kind; strings are `large_utf8` so a
+/// table's schema does not depend on how much text it holds.
+constexpr const char* format_of(FieldKind kind) noexcept {
+    switch (kind) {
+    case FieldKind::Bool: return "b";
+    case FieldKind::Int8: return "c";
+    case FieldKind::Int16: return "s";
+    case FieldKind::Int32: return "i";
+    case FieldKind::Int64: return "l";
+    case FieldKind::UInt8: return "C";
+    case FieldKind::UInt16: return "S";
+    case FieldKind::UInt32: return "I";
+    case FieldKind::UInt64: return "L";
+    case FieldKind::Float: return "f";
+    case FieldKind::Double: return "g";
+    case FieldKind::String: return "U";
+    case FieldKind::Other: break;
+    }
+    return nullptr;
+}
+
+/// Whether field `I` of `T` is exported.  Read from the descriptor, as the
+/// schema is, so columns and schema leave out the same `Other` fields,
+/// sparse ones included.
+template <Reflectable T, std::size_t I>
+inline constexpr bool exported_v = descriptor_of<T>().fields[I].kind != FieldKind::Other;
+
+/// Fields of `T` that have an Arrow type; `Other` fields are left out.
+template <Reflectable T>
+inline constexpr std::size_t exported_count_v = []<std::size_t... I>(std::index_sequence<I...>) {
+    return (std::size_t{exported_v<T, I>} + ... + 0);
+}(std::make_index_sequence<field_count_v<T>>{});
+
+/// Stands in for the data of empty columns, whose storage may be null.
+inline constexpr std::uint64_t empty_buffer = 0;
+
+/// Owns one schema node.  Each child has its own, so a consumer may move
+/// children out and release them independently, as the interface allows.
+struct SchemaData {
+    std::string name;
+    std::vector<ArrowSchema> children;
+    std::vector<ArrowSchema*> child_pointers;
+
+    ~SchemaData() {
+        for (ArrowSchema& child : children)
+            if (child.release)
+                child.release(&child);
+    }
+};
+
+inline void release_schema(ArrowSchema* schema) noexcept {
+    delete static_cast<SchemaData*>(schema->private_data);
+    schema->release = nullptr;
+}
+
+/// Owns one array node: the buffers built for it (bit-packed booleans,
+/// string offsets and bytes) and its children.  Scalar columns own nothing;
+/// their data buffer is the table's column.
+struct ArrayData {
+    const void* buffers[3] = {};
+    std::unique_ptr<std::uint8_t[]> bits;
+    std::unique_ptr<std::int64_t[]> offsets;
+    std::unique_ptr<char[]> chars;
+    std::vector<ArrowArray> children;
+    std::vector<ArrowArray*> child_pointers;
+
+    ~ArrayData() {
+        for (ArrowArray& child : children)
+            if (child.release)
+                child.release(&child);
+    }
+};
+
+inline void release_array(ArrowArray* array) noexcept {
+    delete static_cast<ArrayData*>(array->private_data);
+    array->release = nullptr;
+}
+
+inline void fill_schema(ArrowSchema& schema, const char* format, std::unique_ptr<SchemaData> data,
+                        std::int64_t flags) noexcept {
+    schema = {format, data->name.c_str(), nullptr, flags, static_cast<std::int64_t>(data->children.size()),
+              data->children.empty() ? nullptr : data->child_pointers.data(), nullptr, &release_schema,
+              data.get()};
+    data.release();
+}
+
+inline void fill_array(ArrowArray& array, std::int64_t length, std::int64_t n_buffers,
+                       std::unique_ptr<ArrayData> data) noexcept {
+    array = {length, 0, 0, n_buffers, static_cast<std::int64_t>(data->children.size()), data->buffers,
+             data->children.empty() ? nullptr : data->child_pointers.data(), nullptr, &release_array,
+             data.get()};
+    data.release();
+}
+
+template <Reflectable T>
+void export_schema(ArrowSchema& schema) {
+    const BeanDescriptor& d = descriptor_of<T>();
+    auto data = std::make_unique<SchemaData>();
+    data->name.assign(d.name);
+    data->children.resize(exported_count_v<T>);  // Zeroed, so release is null until filled.
+    data->child_pointers.reserve(exported_count_v<T>);
+    for (ArrowSchema& child : data->children)
+        data->child_pointers.push_back(&child);
+    std::size_t at = 0;
+    for (const FieldDescriptor& f : d.fields) {
+        if (f.kind == FieldKind::Other)
+            continue;
+        auto field = std::make_unique<SchemaData>();
+        field->name.assign(f.name);
+        fill_schema(data->children[at++], format_of(f.kind), std::move(field), 0);
+    }
+    fill_schema(schema, "+s", std::move(data), 0);
+}
+
+template <std::size_t I, Reflectable T>
+void export_column(const BeanTable<T>& table, ArrowArray& array) {
+    using F = field_t<T, I>;
+    const auto column = table.template column<I>();
+    const std::size_t n = column.size();
+    auto data = std::make_unique<ArrayData>();
+    std::int64_t n_buffers = 2;
+    if constexpr (field_kind_v<F> == FieldKind::Bool) {
+        // Arrow booleans are bit-packed; this is the one scalar kind copied.
+        const std::size_t bytes = (n + 7) / 8;
+        data->bits = std::make_unique<std::uint8_t[]>(bytes ? bytes : 1);
+        for (std::size_t i = 0; i < n; ++i)
+            data->bits[i / 8] |= static_cast<std::uint8_t>(column[i]) << (i % 8);
+        data->buffers[1] = data->bits.get();
+    } else if constexpr (field_kind_v<F> == FieldKind::String) {
+        data->offsets = std::make_unique<std::int64_t[]>(n + 1);
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            data->offsets[i] = static_cast<std::int64_t>(total);
+            total += column[i].size();
+        }
+        data->offsets[n] = static_cast<std::int64_t>(total);
+        data->chars = std::make_unique<char[]>(total ? total : 1);
+        for (std::size_t i = 0; i < n; ++i)
+            std::memcpy(data->chars.get() + data->offsets[i], column[i].data(), column[i].size());
+        data->buffers[1] = data->offsets.get();
+        data->buffers[2] = data->chars.get();
+        n_buffers = 3;
+    } else {
+        data->buffers[1] = n ? static_cast<const void*>(column.data()) : &empty_buffer;
+    }
+    fill_array(array, static_cast<std::int64_t>(n), n_buffers, std::move(data));
+}
+
+}  // namespace detail
+
+/// Describes the Arrow type of `BeanTable<T>` exports: a non-nullable
+/// struct with one child per field, in declaration order.  Fields of kind
+/// `Other` have no Arrow type and are left out.
+///
+/// `schema` is filled in the producer role of the Arrow C Data Interface;
+/// the consumer calls `schema->release(schema)` when done.  Throws
+/// `std::bad_alloc`, leaving `schema` untouched.
+template <Reflectable T>
+void export_schema(ArrowSchema* schema) {
+    detail::export_schema<T>(*schema);
+}
+
+/// Exports `table` as an Arrow struct array with the type given by
+/// `export_schema<T>()`, filling both `array` and `schema`.
+///
+/// Numeric columns are not copied: their Arrow data buffers are the table's
+/// own columns, valid until the table is next modified or destroyed, and the
+/// consumer must be done with them by then.  Booleans are bit-packed and
+/// strings gathered into offsets and bytes, both into buffers owned by the
+/// export.  The consumer releases each struct with its `release` callback.
+/// Throws `std::bad_alloc`, leaving both structs untouched.
+template <Reflectable T>
+void export_table(const BeanTable<T>& table, ArrowArray* array, ArrowSchema* schema) {
+    constexpr std::size_t n = detail::exported_count_v<T>;
+    auto data = std::make_unique<detail::ArrayData>();
+    data->children.resize(n);
+    data->child_pointers.reserve(n);
+    for (ArrowArray& child : data->children)
+        data->child_pointers.push_back(&child);
+    std::size_t at = 0;
+    const auto column = [&]<std::size_t I>() {
+        if constexpr (detail::exported_v<T, I>)
+            detail::export_column<I>(table, data->children[at++]);
+    };
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        (column.template operator()<I>(), ...);
+    }(std::make_index_sequence<field_count_v<T>>{});
+
+    ArrowSchema exported_schema;
+    detail::export_schema<T>(exported_schema);
+    detail::fill_array(*array, static_cast<std::int64_t>(table.size()), 1, std::move(data));
+    *schema = exported_schema;
+}
+
+}  // namespace beans::arrow
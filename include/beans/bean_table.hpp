@@ -0,0 +1,201 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <utility>
+
+#include "detail/listeners.hpp"
+#include "detail/vector.hpp"
+#include "fixed_string.hpp"
+#include "list_change.hpp"
+#include "reflect.hpp"
+
+namespace beans {
+
+/// Column-oriented storage for many beans of one type: each field lives in
+/// its own contiguous column, so scans over one field touch only that field.
+///
+/// Rows keep their insertion order.  Columns relocate trivially relocatable
+/// field types with realloc/memmove on growth and erasure.
+///
+/// Listeners receive a `ListChange` for every insertion, removal and
+/// replacement made through the table's mutators.  Writes through the
+/// references returned by `get()` and `column()` are not reported; use
+/// `set()` or `assign()` for changes others should see.  Listeners are not
+/// copied with the table.
+template <Reflectable T>
+class BeanTable {
+    template <class Seq>
+    struct columns_for;
+    template <std::size_t... I>
+    struct columns_for<std::index_sequence<I...>> {
+        using type = std::tuple<detail::Vector<field_t<T, I>>...>;
+    };
+
+public:
+    using bean_type = T;
+    using Listener = Function<void(const BeanTable&, const ListChange&)>;
+    static constexpr std::size_t column_count = field_count_v<T>;
+
+    static constexpr const BeanDescriptor& descriptor() noexcept { return descriptor_of<T>(); }
+
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    void reserve(std::size_t n) {
+        for_each_column([n](auto& column) { column.reserve(n); });
+    }
+
+    /// Appends `bean` as a new row and returns its index.
+    std::size_t push_back(const T& bean) {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (std::get<I>(columns_).push_back(beans::get<I>(bean)), ...);
+        }(indices());
+        ++size_;
+        changed(ListChange::Kind::Inserted, size_ - 1, size_);
+        return size_ - 1;
+    }
+
+    std::size_t push_back(T&& bean) {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (std::get<I>(columns_).push_back(take<I>(bean)), ...);
+        }(indices());
+        ++size_;
+        changed(ListChange::Kind::Inserted, size_ - 1, size_);
+        return size_ - 1;
+    }
+
+    /// Inserts `bean` before row `pos`.
+    void insert(std::size_t pos, const T& bean) {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (std::get<I>(columns_).emplace(pos, beans::get<I>(bean)), ...);
+        }(indices());
+        ++size_;
+        changed(ListChange::Kind::Inserted, pos, pos + 1);
+    }
+
+    /// Removes rows `[first, last)`, keeping the order of the others.
+    void erase(std::size_t first, std::size_t last) {
+        if (first >= last)
+            return;
+        for_each_column([=](auto& column) { column.erase(first, last); });
+        size_ -= last - first;
+        changed(ListChange::Kind::Removed, first, last);
+    }
+
+    void erase(std::size_t row) { erase(row, row + 1); }
+
+    void clear() { erase(0, size_); }
+
+    /// Copies row `row` out into a bean.  Only fields that differ from a
+    /// default bean are written, so sparse fields left at their default
+    /// allocate nothing and nullable fields holding their default stay null:
+    /// columns keep values, not presence.
+    T row(std::size_t row) const {
+        T bean{};
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (store<I>(bean, std::get<I>(columns_)[row]), ...);
+        }(indices());
+        return bean;
+    }
+
+    /// Overwrites row `row` with `bean`.
+    void assign(std::size_t row, const T& bean) {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((std::get<I>(columns_)[row] = beans::get<I>(bean)), ...);
+        }(indices());
+        changed(ListChange::Kind::Replaced, row, row + 1);
+    }
+
+    /// Overwrites field `I` of row `row`.
+    template <std::size_t I>
+    void set(std::size_t row, field_t<T, I> value) {
+        std::get<I>(columns_)[row] = std::move(value);
+        changed(ListChange::Kind::Replaced, row, row + 1);
+    }
+    template <FixedString Name>
+    void set(std::size_t row, field_t<T, field_index_v<T, Name>> value) {
+        set<field_index_v<T, Name>>(row, std::move(value));
+    }
+
+    template <std::size_t I>
+    field_t<T, I>& get(std::size_t row) noexcept {
+        return std::get<I>(columns_)[row];
+    }
+    template <std::size_t I>
+    const field_t<T, I>& get(std::size_t row) const noexcept {
+        return std::get<I>(columns_)[row];
+    }
+    template <FixedString Name>
+    auto& get(std::size_t row) noexcept {
+        return get<field_index_v<T, Name>>(row);
+    }
+    template <FixedString Name>
+    const auto& get(std::size_t row) const noexcept {
+        return get<field_index_v<T, Name>>(row);
+    }
+
+    /// Contiguous view of field `I` across all rows.
+    template <std::size_t I>
+    std::span<field_t<T, I>> column() noexcept {
+        auto& c = std::get<I>(columns_);
+        return {c.data(), c.size()};
+    }
+    template <std::size_t I>
+    std::span<const field_t<T, I>> column() const noexcept {
+        const auto& c = std::get<I>(columns_);
+        return {c.data(), c.size()};
+    }
+    template <FixedString Name>
+    auto column() noexcept {
+        return column<field_index_v<T, Name>>();
+    }
+    template <FixedString Name>
+    auto column() const noexcept {
+        return column<field_index_v<T, Name>>();
+    }
+
+    ListenerId subscribe(Listener listener) { return listeners_.subscribe(std::move(listener)); }
+    bool unsubscribe(ListenerId id) { return listeners_.unsubscribe(id); }
+    std::size_t listener_count() const noexcept { return listeners_.size(); }
+
+private:
+    static constexpr auto indices() noexcept { return std::make_index_sequence<column_count>{}; }
+
+    /// Field `I` of `bean` to move from.  Fields without a fixed address are
+    /// copied through const access instead, which does not materialise them.
+    template <std::size_t I>
+    static decltype(auto) take(T& bean) noexcept {
+        if constexpr (field_addressable_v<T, I>)
+            return std::move(beans::get<I>(bean));
+        else
+            return beans::get<I>(std::as_const(bean));
+    }
+
+    template <std::size_t I>
+    static void store(T& bean, const field_t<T, I>& value) {
+        if constexpr (std::equality_comparable<field_t<T, I>>) {
+            if (beans::get<I>(std::as_const(bean)) == value)
+                return;
+        }
+        beans::get<I>(bean) = value;
+    }
+
+    template <class F>
+    void for_each_column(F&& f) {
+        std::apply([&](auto&... column) { (f(column), ...); }, columns_);
+    }
+
+    void changed(ListChange::Kind kind, std::size_t from, std::size_t to) {
+        if (!listeners_.empty())
+            listeners_.notify(*this, ListChange{kind, from, to});
+    }
+
+    typename columns_for<std::make_index_sequence<column_count>>::type columns_;
+    std::size_t size_ = 0;
+    detail::LazyListenerList<const BeanTable&, const ListChange&> listeners_;
+};
+
+}  // namespace beans
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "detail/listeners.hpp"
+#include "detail/vector.hpp"
+#include "function.hpp"
+
+namespace beans {
+
+/// Index of a node in a `BeanTree`.  Ids of removed nodes are reused.
+using NodeId = std::uint32_t;
+
+inline constexpr NodeId no_node = ~NodeId{0};
+
+/// A structural change to a `BeanTree`.  `parent` is the node's parent after
+/// the change; for `Removed` it is the parent the subtree is leaving.
+/// `Removed` fires once per removed subtree, while the subtree is still
+/// attached.
+struct TreeChange {
+    enum class Kind { Added, Removed, Moved };
+
+    Kind kind;
+    NodeId node;
+    NodeId parent;
+};
+
+/// A forest of beans with parent/child links.  Beans and links are kept in
+/// two arrays indexed by `NodeId`, so a tree of millions of nodes costs one
+/// `T` and 24 bytes of links per node.  Children keep insertion order.
+///
+/// Structural listeners are how per-node data kept beside the tree, such as
+/// `InheritedProperty` columns, follows the structure.
+template <class T>
+class BeanTree {
+public:
+    using value_type = T;
+    using Listener = Function<void(const BeanTree&, const TreeChange&)>;
+
+    BeanTree() = default;
+    BeanTree(const BeanTree&) = delete;
+    BeanTree& operator=(const BeanTree&) = delete;
+
+    /// Number of live nodes.
+    std::size_t size() const noexcept { return size_; }
+
+    /// One past the largest id in use; per-node columns need this many slots.
+    std::size_t capacity() const noexcept { return links_.size(); }
+
+    bool contains(NodeId node) const noexcept { return node < links_.size() && links_[node].live; }
+
+    T& operator[](NodeId node) noexcept { return beans_[node]; }
+    const T& operator[](NodeId node) const noexcept { return beans_[node]; }
+
+    NodeId parent(NodeId node) const noexcept { return links_[node].parent; }
+    NodeId first_child(NodeId node) const noexcept { return links_[node].first_child; }
+    NodeId next_sibling(NodeId node) const noexcept { return links_[node].next_sibling; }
+
+    /// Calls `f(child)` for each child of `node`, in order.
+    template <class F>
+    void for_each_child(NodeId node, F&& f) const {
+        for (NodeId c = links_[node].first_child; c != no_node; c = links_[c].next_sibling)
+            f(c);
+    }
+
+    /// Adds a root node.
+    NodeId add_root(T bean = T{}) { return add(no_node, std::move(bean)); }
+
+    /// Adds a node as the last child of `parent`.
+    NodeId add_child(NodeId parent, T bean = T{}) { return add(parent, std::move(bean)); }
+
+    /// Removes `node` and its descendants.
+    void remove(NodeId node) {
+        changed(TreeChange::Kind::Removed, node, links_[node].parent);
+        unlink(node);
+        // Free the subtree with an explicit stack: trees can be deep.
+        scratch_.clear();
+        scratch_.emplace_back(node);
+        while (!scratch_.empty()) {
+            const NodeId n = scratch_.back();
+            scratch_.pop_back();
+            for (NodeId c = links_[n].first_child; c != no_node; c = links_[c].next_sibling)
+                scratch_.emplace_back(c);
+            beans_[n] = T{};
+            links_[n] = Links{};
+            links_[n].live = false;
+            links_[n].next_sibling = free_;
+            free_ = n;
+            --size_;
+        }
+    }
+
+    /// Makes `node` the last child of `parent`, or a root if `parent` is
+    /// `no_node`.  `parent` must not be inside `node`'s subtree.
+    void move(NodeId node, NodeId parent) {
+        unlink(node);
+        link(node, parent);
+        changed(TreeChange::Kind::Moved, node, parent);
+    }
+
+    ListenerId subscribe(Listener listener) { return listeners_.subscribe(std::move(listener)); }
+
+    /// Removes the listener registered under `id`; returns false if unknown.
+    bool unsubscribe(ListenerId id) { return listeners_.unsubscribe(id); }
+
+private:
+    struct Links {
+        NodeId parent = no_node;
+        NodeId first_child = no_node;
+        NodeId last_child = no_node;
+        NodeId prev_sibling = no_node;
+        NodeId next_sibling = no_node;  // Next free id while on the free list.
+        bool live = true;
+    };
+
+    NodeId add(NodeId parent, T&& bean) {
+        NodeId node;
+        if (free_ != no_node) {
+            node = free_;
+            free_ = links_[node].next_sibling;
+            links_[node] = Links{};
+            beans_[node] = std::move(bean);
+        } else {
+            node = static_cast<NodeId>(links_.size());
+            links_.emplace_back();
+            beans_.emplace_back(std::move(bean));
+        }
+        ++size_;
+        link(node, parent);
+        changed(TreeChange::Kind::Added, node, parent);
+        return node;
+    }
+
+    void link(NodeId node, NodeId parent) noexcept {
+        Links& l = links_[node];
+        l.parent = parent;
+        if (parent == no_node)
+            return;
+        Links& p = links_[parent];
+        l.prev_sibling = p.last_child;
+        if (p.last_child != no_node)
+            links_[p.last_child].next_sibling = node;
+        else
+            p.first_child = node;
+        p.last_child = node;
+    }
+
+    void unlink(NodeId node) noexcept {
+        Links& l = links_[node];
+        if (l.parent != no_node) {
+            Links& p = links_[l.parent];
+            if (l.prev_sibling != no_node)
+                links_[l.prev_sibling].next_sibling = l.next_sibling;
+            else
+                p.first_child = l.next_sibling;
+            if (l.next_sibling != no_node)
+                links_[l.next_sibling].prev_sibling = l.prev_sibling;
+            else
+                p.last_child = l.prev_sibling;
+        }
+        l.parent = l.prev_sibling = l.next_sibling = no_node;
+    }
+
+    void changed(TreeChange::Kind kind, NodeId node, NodeId parent) {
+        if (!listeners_.empty())
+            listeners_.notify(*this, TreeChange{kind, node, parent});
+    }
+
+    detail::Vector<T> beans_;
+    detail::Vector<Links> links_;
+    detail::Vector<NodeId> scratch_;
+    NodeId free_ = no_node;
+    std::size_t size_ = 0;
+    detail::ListenerList<const BeanTree&, const TreeChange&> listeners_;
+};
+
+}  // namespace beans
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "property.hpp"
+
+namespace beans {
+
+/// Base of every binding expression node.  It lives in `beans` so the
+/// operators below are found by argument-dependent lookup on any node.
+struct ExpressionTag {};
+
+namespace detail {
+
+template <class T>
+struct is_property : std::false_type {};
+template <class T>
+struct is_property<Property<T>> : std::true_type {};
+
+}  // namespace detail
+
+/// A binding expression: a tree of properties, constants and operators that
+/// evaluates with `eval()` and lists the properties it reads with
+/// `for_each_dependency()`.
+template <class E>
+concept Expression = std::derived_from<E, ExpressionTag>;
+
+namespace detail {
+
+/// Expressions convert to their value, so `double v = a * b;` on two
+/// properties still computes a number.
+template <class Derived>
+struct ExpressionBase : ExpressionTag {
+    template <class U>
+        requires std::convertible_to<decltype(std::declval<const Derived&>().eval()), U>
+    operator U() const {
+        return static_cast<const Derived&>(*this).eval();
+    }
+};
+
+template <class T>
+struct PropertyRef : ExpressionBase<PropertyRef<T>> {
+    static constexpr std::size_t dependency_count = 1;
+
+    Property<T>* property;
+
+    explicit PropertyRef(Property<T>& p) noexcept : property(&p) {}
+
+    const T& eval() const noexcept { return property->get(); }
+
+    template <class F>
+    void for_each_dependency(F& f) const {
+        f(*property);
+    }
+};
+
+template <class T>
+struct Constant : ExpressionBase<Constant<T>> {
+    static constexpr std::size_t dependency_count = 0;
+
+    T value;
+
+    explicit Constant(T v) : value(std::move(v)) {}
+
+    const T& eval() const noexcept { return value; }
+
+    template <class F>
+    void for_each_dependency(F&) const {}
+};
+
+template <class Op, class E>
+struct Unary : ExpressionBase<Unary<Op, E>> {
+    static constexpr std::size_t dependency_count = E::dependency_count;
+
+    [[no_unique_address]] Op op;
+    E operand;
+
+    explicit Unary(E e) : operand(std::move(e)) {}
+
+    decltype(auto) eval() const { return op(operand.eval()); }
+
+    template <class F>
+    void for_each_dependency(F& f) const {
+        operand.for_each_dependency(f);
+    }
+};
+
+template <class Op, class L, class R>
+struct Binary : ExpressionBase<Binary<Op, L, R>> {
+    static constexpr std::size_t dependency_count = L::dependency_count + R::dependency_count;
+
+    [[no_unique_address]] Op op;
+    L lhs;
+    R rhs;
+
+    Binary(L l, R r) : lhs(std::move(l)), rhs(std::move(r)) {}
+
+    decltype(auto) eval() const { return op(lhs.eval(), rhs.eval()); }
+
+    template <class F>
+    void for_each_dependency(F& f) const {
+        lhs.for_each_dependency(f);
+        rhs.for_each_dependency(f);
+    }
+};
+
+/// A property used in an expression; it must be mutable so the binding can
+/// subscribe to it.
+template <class X>
+concept PropertyOperand = is_property<std::remove_cvref_t<X>>::value &&
+                          std::is_lvalue_reference_v<X> &&
+                          !std::is_const_v<std::remove_reference_t<X>>;
+
+template <class X>
+concept NodeOperand = Expression<std::remove_cvref_t<X>> || PropertyOperand<X>;
+
+template <class X>
+concept ValueOperand = !Expression<std::remove_cvref_t<X>> &&
+                       !is_property<std::remove_cvref_t<X>>::value &&
+                       std::copy_constructible<std::decay_t<X>>;
+
+template <class L, class R>
+concept BinaryOperands = (NodeOperand<L> && (NodeOperand<R> || ValueOperand<R>)) ||
+                         (ValueOperand<L> && NodeOperand<R>);
+
+template <class X>
+auto as_expression(X&& x) {
+    if constexpr (Expression<std::remove_cvref_t<X>>)
+        return std::remove_cvref_t<X>(std::forward<X>(x));
+    else if constexpr (is_property<std::remove_cvref_t<X>>::value)
+        return PropertyRef<typename std::remove_cvref_t<X>::value_type>(x);
+    else
+        return Constant<std::decay_t<X>>(std::forward<X>(x));
+}
+
+template <class Op, class L, class R>
+auto make_binary(L&& l, R&& r) {
+    using LE = decltype(as_expression(std::forward<L>(l)));
+    using RE = decltype(as_expression(std::forward<R>(r)));
+    return Binary<Op, LE, RE>(as_expression(std::forward<L>(l)), as_expression(std::forward<R>(r)));
+}
+
+}  // namespace detail
+
+#define BEANS_BINDING_OPERATOR(op, functor)                                          \
+    template <class L, class R>                                                      \
+        requires detail::BinaryOperands<L, R>                                        \
+    auto operator op(L&& l, R&& r) {                                                 \
+        return detail::make_binary<functor>(std::forward<L>(l), std::forward<R>(r)); \
+    }
+
+BEANS_BINDING_OPERATOR(+, std::plus<>)
+BEANS_BINDING_OPERATOR(-, std::minus<>)
+BEANS_BINDING_OPERATOR(*, std::multiplies<>)
+BEANS_BINDING_OPERATOR(/, std::divides<>)
+BEANS_BINDING_OPERATOR(%, std::modulus<>)
+BEANS_BINDING_OPERATOR(<, std::less<>)
+BEANS_BINDING_OPERATOR(<=, std::less_equal<>)
+BEANS_BINDING_OPERATOR(>, std::greater<>)
+BEANS_BINDING_OPERATOR(>=, std::greater_equal<>)
+BEANS_BINDING_OPERATOR(==, std::equal_to<>)
+BEANS_BINDING_OPERATOR(!=, std::not_equal_to<>)
+
+#undef BEANS_BINDING_OPERATOR
+
+template <class X>
+    requires detail::NodeOperand<X>
+auto operator-(X&& x) {
+    using E = decltype(detail::as_expression(std::forward<X>(x)));
+    return detail::Unary<std::negate<>, E>(detail::as_expression(std::forward<X>(x)));
+}
+
+template <class X>
+    requires detail::NodeOperand<X>
+auto operator!(X&& x) {
+    using E = decltype(detail::as_expression(std::forward<X>(x)));
+    return detail::Unary<std::logical_not<>, E>(detail::as_expression(std::forward<X>(x)));
+}
+
+namespace detail {
+
+struct BindingStateBase {
+    virtual ~BindingStateBase() = default;
+};
+
+template <class T, class E>
+class BindingState final : public BindingStateBase {
+public:
+    BindingState(Property<T>& target, E expr) : target_(&target), expr_(std::move(expr)) {}
+
+    BindingState(const BindingState&) = delete;
+    BindingState& operator=(const BindingState&) = delete;
+
+    void connect() {
+        std::size_t i = 0;
+        auto subscribe = [&](auto& property) {
+            // A property read twice by the expression is subscribed once.
+            for (std::size_t j = 0; j < i; ++j) {
+                if (sources_[j] == &property) {
+                    ++i;
+                    return;
+                }
+            }
+            sources_[i] = &property;
+            ids_[i++] = property.subscribe([this](const auto&, const auto&) { update(); });
+        };
+        expr_.for_each_dependency(subscribe);
+        update();
+    }
+
+    ~BindingState() override {
+        std::size_t i = 0;
+        auto unsubscribe = [&](auto& property) {
+            if (ids_[i])
+                property.unsubscribe(ids_[i]);
+            ++i;
+        };
+        expr_.for_each_dependency(unsubscribe);
+    }
+
+    void update() {
+        // A binding whose target feeds back into its own expression stops
+        // after one evaluation instead of recursing.
+        if (updating_)
+            return;
+        updating_ = true;
+        struct Reset {
+            bool& flag;
+            ~Reset() { flag = false; }
+        } reset{updating_};
+        target_->set(static_cast<T>(expr_.eval()));
+    }
+
+private:
+    static constexpr std::size_t n = E::dependency_count;
+
+    Property<T>* target_;
+    E expr_;
+    std::array<const void*, n> sources_{};
+    std::array<ListenerId, n> ids_{};
+    bool updating_ = false;
+};
+
+}  // namespace detail
+
+/// Keeps a binding alive; destroying or resetting it disconnects the target
+/// from the expression's properties.
+class Binding {
+public:
+    Binding() noexcept = default;
+    explicit Binding(std::unique_ptr<detail::BindingStateBase> state) noexcept
+        : state_(std::move(state)) {}
+
+    bool bound() const noexcept { return state_ != nullptr; }
+    explicit operator bool() const noexcept { return bound(); }
+
+    void reset() noexcept { state_.reset(); }
+
+private:
+    std::unique_ptr<detail::BindingStateBase> state_;
+};
+
+/// Binds `target` to `expr`: `target` is set to the expression's value now
+/// and whenever one of the properties it reads changes.
+///
+///     beans::Binding b = beans::bind(total, a.qty * b.price + fee);
+///
+/// The expression is a compile-time tree, so an update evaluates it as one
+/// inlined function with no intermediate listeners, allocations or indirect
+/// calls per operator; the binding allocates once and subscribes one listener
+/// per distinct property.  The target and every property in the expression
+/// must outlive the returned `Binding`.
+template <class T, class X>
+    requires detail::NodeOperand<X> &&
+             std::convertible_to<decltype(detail::as_expression(std::declval<X>()).eval()), T>
+[[nodiscard]] Binding bind(Property<T>& target, X&& expr) {
+    using E = decltype(detail::as_expression(std::forward<X>(expr)));
+    auto state =
+        std::make_unique<detail::BindingState<T, E>>(target, detail::as_expression(std::forward<X>(expr)));
+    state->connect();
+    return Binding(std::move(state));
+}
+
+}  // namespace beans
@@ -0,0 +1,112 @@
+/* Stable C ABI for reading beans and bean tables from other languages.
+ *
+ * The ABI is a set of plain structs holding function pointers, filled in on
+ * the C++ side by beans::c::export_bean() and beans::c::export_table() (see
+ * <beans/c_api.hpp>).  A consumer needs only this header: there are no
+ * symbols to link against, so a handle can be passed to code built by any
+ * compiler or language that speaks the C calling convention.
+ *
+ * Scalar fields and table columns are exposed in place: `column()` returns
+ * the table's own contiguous storage, valid until the table is next
+ * modified.  Strings are returned as (pointer, length) views of the C++
+ * std::string, valid under the same rule.  Handles are not thread-safe;
+ * readers must synchronise with the thread that owns the C++ objects.
+ *
+ * Compatibility: fields are only ever appended to these structs, and
+ * `abi_version` is bumped when that happens.
+ */
+#ifndef BEANS_C_BEANS_H
+#define BEANS_C_BEANS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BEANS_ABI_VERSION 1u
+
+/* Values of beans_field::kind; they match beans::FieldKind. */
+enum beans_kind {
+    BEANS_KIND_BOOL = 0,
+    BEANS_KIND_INT8 = 1,
+    BEANS_KIND_INT16 = 2,
+    BEANS_KIND_INT32 = 3,
+    BEANS_KIND_INT64 = 4,
+    BEANS_KIND_UINT8 = 5,
+    BEANS_KIND_UINT16 = 6,
+    BEANS_KIND_UINT32 = 7,
+    BEANS_KIND_UINT64 = 8,
+    BEANS_KIND_FLOAT = 9,
+    BEANS_KIND_DOUBLE = 10,
+    BEANS_KIND_STRING = 11,
+    BEANS_KIND_OTHER = 12
+};
+
+/* Values passed to beans_table_listener; they match beans::ListChange::Kind. */
+enum beans_change_kind {
+    BEANS_CHANGE_INSERTED = 0,
+    BEANS_CHANGE_REMOVED = 1,
+    BEANS_CHANGE_REPLACED = 2
+};
+
+/* A string view; `data` is not NUL-terminated. */
+typedef struct beans_str {
+    const char* data;
+    size_t size;
+} beans_str;
+
+typedef struct beans_field {
+    beans_str name;
+    uint64_t hash; /* 64-bit FNV-1a of the name */
+    uint32_t kind; /* enum beans_kind */
+    uint32_t size; /* sizeof the C++ field */
+} beans_field;
+
+typedef struct beans_type {
+    beans_str name;
+    const beans_field* fields; /* declaration order */
+    size_t field_count;
+} beans_type;
+
+typedef void (*beans_bean_listener)(void* user, size_t field);
+typedef void (*beans_table_listener)(void* user, uint32_t change_kind, size_t from, size_t to);
+
+/* One bean. */
+typedef struct beans_bean {
+    uint32_t abi_version;
+    const beans_type* type;
+    void* self;
+    /* Address of a scalar field (kinds BOOL to DOUBLE), or NULL. */
+    const void* (*field)(const void* self, size_t field);
+    /* Contents of a STRING field; {NULL, 0} for other kinds. */
+    beans_str (*string)(const void* self, size_t field);
+    /* NULL if the bean type does not report changes.  Returns 0 on failure. */
+    uint64_t (*subscribe)(void* self, beans_bean_listener listener, void* user);
+    /* Returns 1 if `id` was subscribed, 0 otherwise. */
+    int (*unsubscribe)(void* self, uint64_t id);
+} beans_bean;
+
+/* A column-oriented table of beans of one type. */
+typedef struct beans_table {
+    uint32_t abi_version;
+    const beans_type* type;
+    void* self;
+    size_t (*size)(const void* self);
+    /* First element of a scalar column (`size()` elements of the field's
+     * kind), or NULL for STRING and OTHER columns and for empty tables. */
+    const void* (*column)(const void* self, size_t field);
+    /* Contents of a STRING cell; {NULL, 0} for other kinds. */
+    beans_str (*string)(const void* self, size_t field, size_t row);
+    /* Returns 0 on failure. */
+    uint64_t (*subscribe)(void* self, beans_table_listener listener, void* user);
+    /* Returns 1 if `id` was subscribed, 0 otherwise. */
+    int (*unsubscribe)(void* self, uint64_t id);
+} beans_table;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BEANS_C_BEANS_H */
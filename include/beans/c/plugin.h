@@ -0,0 +1,61 @@
+/* C ABI for bean types provided by plugins.
+ *
+ * A plugin is a shared object exporting
+ *
+ *     int beans_plugin_register(const beans_registrar* registrar);
+ *
+ * which calls `registrar->register_type` once per bean type and returns 0 on
+ * success.  C++ plugins can use BEANS_PLUGIN and beans::c::register_types<T...>()
+ * from <beans/plugin.hpp> instead of filling these structs by hand.
+ *
+ * Field access goes through byte offsets rather than calls, so once a host
+ * has looked a field up it reads plugin beans as directly as its own.  STRING
+ * fields are std::string objects; host and plugin must therefore share a C++
+ * standard library, as they must for any other C++ type in a plugin.
+ *
+ * Build C++ plugins with -fvisibility=hidden.  Otherwise the per-type
+ * statics behind beans::c::type_info<T>() are exported as unique symbols,
+ * and two plugins that both define a type with the same name end up sharing
+ * one description.
+ */
+#ifndef BEANS_C_PLUGIN_H
+#define BEANS_C_PLUGIN_H
+
+#include "beans.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BEANS_PLUGIN_ENTRY "beans_plugin_register"
+
+/* Everything the host needs to create and read beans of one type.  All
+ * pointers must stay valid until the plugin is unloaded. */
+typedef struct beans_type_info {
+    const beans_type* type;
+    const size_t* offsets; /* byte offset of each field, in type->fields order;
+                              SIZE_MAX for fields that cannot be written in
+                              place: those stored out of line, and nullable
+                              fields, whose presence is kept elsewhere */
+    size_t size;
+    size_t align;
+    void (*construct)(void* memory); /* default-constructs a bean in `memory` */
+    void (*destroy)(void* bean);
+    void (*copy)(void* memory, const void* bean); /* may be NULL */
+} beans_type_info;
+
+typedef struct beans_registrar {
+    uint32_t abi_version;
+    void* self;
+    /* Returns 0 on success, nonzero if the type is malformed or a type with
+     * the same name is already registered. */
+    int (*register_type)(void* self, const beans_type_info* info);
+} beans_registrar;
+
+typedef int (*beans_plugin_register_fn)(const beans_registrar* registrar);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BEANS_C_PLUGIN_H */
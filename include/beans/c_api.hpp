@@ -0,0 +1,176 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "bean_table.hpp"
+#include "c/beans.h"
+#include "descriptor.hpp"
+#include "reflect.hpp"
+
+namespace beans::c {
+
+static_assert(static_cast<std::uint32_t>(FieldKind::String) == BEANS_KIND_STRING &&
+              static_cast<std::uint32_t>(FieldKind::Other) == BEANS_KIND_OTHER);
+static_assert(static_cast<std::uint32_t>(ListChange::Kind::Replaced) == BEANS_CHANGE_REPLACED);
+
+namespace detail {
+
+constexpr beans_str to_c(std::string_view s) noexcept { return {s.data(), s.size()}; }
+
+constexpr bool is_scalar(FieldKind kind) noexcept {
+    return kind != FieldKind::String && kind != FieldKind::Other;
+}
+
+template <Reflectable T>
+struct CType {
+    static constexpr std::size_t n = field_count_v<T>;
+
+    std::array<beans_field, n> fields{};
+    beans_type type{};
+
+    CType() noexcept {
+        const BeanDescriptor& d = descriptor_of<T>();
+        for (std::size_t i = 0; i < n; ++i) {
+            const FieldDescriptor& f = d.fields[i];
+            fields[i] = {to_c(f.name), f.hash, static_cast<std::uint32_t>(f.kind),
+                         static_cast<std::uint32_t>(f.size)};
+        }
+        type = {to_c(d.name), fields.data(), n};
+    }
+};
+
+/// The C description of `T`, built once.
+template <Reflectable T>
+const beans_type* c_type() noexcept {
+    static const CType<T> type;
+    return &type.type;
+}
+
+/// Beans that report changes as `(const T&, T::Field)`, as beansc-generated
+/// beans do.
+template <class T>
+concept FieldObservable = requires(T& bean, typename T::Listener listener, ListenerId id) {
+    typename T::Field;
+    { bean.subscribe(std::move(listener)) } -> std::same_as<ListenerId>;
+    bean.unsubscribe(id);
+};
+
+template <Reflectable T>
+struct BeanCalls {
+    static const void* field(const void* self, std::size_t i) noexcept {
+        const FieldDescriptor& f = descriptor_of<T>().fields[i];
+        return is_scalar(f.kind) ? f.get(self) : nullptr;
+    }
+
+    static beans_str string(const void* self, std::size_t i) noexcept {
+        const FieldDescriptor& f = descriptor_of<T>().fields[i];
+        if (f.kind != FieldKind::String)
+            return {nullptr, 0};
+        return to_c(f.ref<std::string>(self));
+    }
+
+    static std::uint64_t subscribe(void* self, beans_bean_listener listener, void* user) noexcept {
+        try {
+            return static_cast<T*>(self)->subscribe(
+                [listener, user](const T&, typename T::Field field) {
+                    listener(user, static_cast<std::size_t>(field));
+                });
+        } catch (...) {
+            return 0;
+        }
+    }
+
+    static int unsubscribe(void* self, std::uint64_t id) noexcept {
+        return static_cast<T*>(self)->unsubscribe(id) ? 1 : 0;
+    }
+};
+
+template <Reflectable T>
+struct TableCalls {
+    using Table = BeanTable<T>;
+
+    static std::size_t size(const void* self) noexcept { return static_cast<const Table*>(self)->size(); }
+
+    static const void* column(const void* self, std::size_t i) noexcept {
+        const Table& table = *static_cast<const Table*>(self);
+        return [&]<std::size_t... I>(std::index_sequence<I...>) {
+            const void* data = nullptr;
+            ((I == i ? void(data = scalar_column<I>(table)) : void()), ...);
+            return data;
+        }(std::make_index_sequence<Table::column_count>{});
+    }
+
+    static beans_str string(const void* self, std::size_t i, std::size_t row) noexcept {
+        const Table& table = *static_cast<const Table*>(self);
+        return [&]<std::size_t... I>(std::index_sequence<I...>) {
+            beans_str s{nullptr, 0};
+            ((I == i ? void(s = string_cell<I>(table, row)) : void()), ...);
+            return s;
+        }(std::make_index_sequence<Table::column_count>{});
+    }
+
+    static std::uint64_t subscribe(void* self, beans_table_listener listener, void* user) noexcept {
+        try {
+            return static_cast<Table*>(self)->subscribe(
+                [listener, user](const Table&, const ListChange& change) {
+                    listener(user, static_cast<std::uint32_t>(change.kind), change.from, change.to);
+                });
+        } catch (...) {
+            return 0;
+        }
+    }
+
+    static int unsubscribe(void* self, std::uint64_t id) noexcept {
+        return static_cast<Table*>(self)->unsubscribe(id) ? 1 : 0;
+    }
+
+private:
+    template <std::size_t I>
+    static const void* scalar_column(const Table& table) noexcept {
+        if constexpr (is_scalar(field_kind_v<field_t<T, I>>)) {
+            auto column = table.template column<I>();
+            return column.empty() ? nullptr : column.data();
+        } else {
+            return nullptr;
+        }
+    }
+
+    template <std::size_t I>
+    static beans_str string_cell(const Table& table, std::size_t row) noexcept {
+        if constexpr (field_kind_v<field_t<T, I>> == FieldKind::String)
+            return to_c(table.template get<I>(row));
+        else
+            return {nullptr, 0};
+    }
+};
+
+}  // namespace detail
+
+/// Describes `bean` through the C ABI.  The handle refers to `bean`, which
+/// must outlive it; the handle itself may be copied freely.
+template <Reflectable T>
+beans_bean export_bean(T& bean) noexcept {
+    using Calls = detail::BeanCalls<T>;
+    beans_bean handle{BEANS_ABI_VERSION, detail::c_type<T>(), &bean, &Calls::field, &Calls::string,
+                      nullptr, nullptr};
+    if constexpr (detail::FieldObservable<T>) {
+        handle.subscribe = &Calls::subscribe;
+        handle.unsubscribe = &Calls::unsubscribe;
+    }
+    return handle;
+}
+
+/// Describes `table` through the C ABI.  The handle refers to `table`, which
+/// must outlive it; the handle itself may be copied freely.
+template <Reflectable T>
+beans_table export_table(BeanTable<T>& table) noexcept {
+    using Calls = detail::TableCalls<T>;
+    return {BEANS_ABI_VERSION, detail::c_type<T>(), &table,         &Calls::size,
+            &Calls::column,    &Calls::string,      &Calls::subscribe, &Calls::unsubscribe};
+}
+
+}  // namespace beans::c
@@ -0,0 +1,664 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "descriptor.hpp"
+#include "detail/listeners.hpp"
+#include "function.hpp"
+#include "plugin.hpp"
+#include "reflect.hpp"
+
+namespace beans {
+
+/// Thrown for malformed or inconsistent configuration.  `line()` is the
+/// 1-based line of a syntax error, or 0 for errors about the whole file.
+class ConfigError : public std::runtime_error {
+public:
+    explicit ConfigError(const std::string& message) : std::runtime_error(message), line_(0) {}
+    ConfigError(std::size_t line, const std::string& message)
+        : std::runtime_error("line " + std::to_string(line) + ": " + message), line_(line) {}
+
+    std::size_t line() const noexcept { return line_; }
+
+private:
+    std::size_t line_;
+};
+
+/// A named bean defined by configuration: its instance and the names of the
+/// beans it depends on.  The instance is shared so code still using it
+/// keeps it alive when a reload replaces it.
+struct BeanDefinition {
+    std::string name;
+    std::uint64_t hash = 0;  ///< `name_hash(name)`
+    std::shared_ptr<DynamicBean> bean;
+    std::vector<std::string> depends;
+};
+
+/// One bean affected by `Container::reload()`.
+struct BeanChange {
+    enum class Kind : std::uint8_t {
+        Added,
+        Removed,
+        Changed,  ///< Its definition changed; it is a new instance.
+        Rebuilt,  ///< Its definition is the same, but a bean it depends on,
+                  ///< directly or not, changed; it is a new instance.
+    };
+
+    Kind kind;
+    std::string name;
+};
+
+namespace detail {
+
+/// Single-pass parser for the configuration subset of TOML the container
+/// reads.  It works on views of the input and writes each value straight
+/// into the field it names, resolved through the type's hash index; there
+/// is no intermediate document.
+class ConfigParser {
+public:
+    ConfigParser(std::string_view text, const TypeRegistry& types) noexcept
+        : p_(text.data()), end_(text.data() + text.size()), types_(types) {}
+
+    std::vector<BeanDefinition> parse() {
+        std::vector<BeanDefinition> out;
+        while (skip_blank_lines()) {
+            if (*p_ == '[') {
+                ++p_;
+                skip_spaces();
+                const std::string_view name = key();
+                skip_spaces();
+                expect(']');
+                end_of_line();
+                for (const BeanDefinition& d : out)
+                    if (d.name == name)
+                        fail("bean '" + std::string(name) + "' is defined twice");
+                out.push_back({std::string(name), name_hash(name), nullptr, {}});
+                continue;
+            }
+            if (out.empty())
+                fail("expected a [bean] section");
+            BeanDefinition& d = out.back();
+            const std::string_view k = key();
+            skip_spaces();
+            expect('=');
+            skip_spaces();
+            if (k == "type")
+                create(d);
+            else if (k == "depends")
+                depends(d);
+            else
+                property(d, k);
+            end_of_line();
+        }
+        for (const BeanDefinition& d : out)
+            if (!d.bean)
+                fail("bean '" + d.name + "' has no type");
+        return out;
+    }
+
+private:
+    [[noreturn]] void fail(const std::string& message) const { throw ConfigError(line_, message); }
+
+    static bool is_key_char(char c) noexcept {
+        return c == '_' || c == '-' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+    }
+
+    void skip_spaces() noexcept {
+        while (p_ != end_ && (*p_ == ' ' || *p_ == '\t'))
+            ++p_;
+    }
+
+    void skip_comment() noexcept {
+        if (p_ != end_ && *p_ == '#')
+            while (p_ != end_ && *p_ != '\n')
+                ++p_;
+    }
+
+    /// Skips whitespace, comments and newlines; false at the end of input.
+    bool skip_blank_lines() noexcept {
+        for (;;) {
+            skip_spaces();
+            skip_comment();
+            if (p_ == end_)
+                return false;
+            if (*p_ == '\r' && p_ + 1 != end_ && p_[1] == '\n')
+                ++p_;
+            if (*p_ != '\n')
+                return true;
+            ++p_;
+            ++line_;
+        }
+    }
+
+    void end_of_line() {
+        skip_spaces();
+        skip_comment();
+        if (p_ != end_ && *p_ == '\r')
+            ++p_;
+        if (p_ != end_ && *p_ != '\n')
+            fail("unexpected text after value");
+    }
+
+    void expect(char c) {
+        if (p_ == end_ || *p_ != c)
+            fail(std::string("expected '") + c + "'");
+        ++p_;
+    }
+
+    std::string_view key() {
+        const char* begin = p_;
+        while (p_ != end_ && is_key_char(*p_))
+            ++p_;
+        if (p_ == begin)
+            fail("expected a key");
+        return {begin, static_cast<std::size_t>(p_ - begin)};
+    }
+
+    void create(BeanDefinition& d) {
+        if (d.bean)
+            fail("type given twice");
+        if (p_ == end_ || (*p_ != '"' && *p_ != '\''))
+            fail("type must be a string");
+        std::string name;
+        string(name);
+        const PluginType* type = types_.find(name);
+        if (!type)
+            fail("unknown bean type '" + name + "'");
+        d.bean = std::make_shared<DynamicBean>(*type);
+        assigned_.assign(type->fields().size(), false);
+    }
+
+    void depends(BeanDefinition& d) {
+        if (!d.depends.empty())
+            fail("depends given twice");
+        expect('[');
+        for (;;) {
+            skip_blank_lines();
+            if (p_ != end_ && *p_ == ']') {
+                ++p_;
+                return;
+            }
+            std::string name;
+            if (p_ == end_ || (*p_ != '"' && *p_ != '\''))
+                fail("depends must be an array of bean names");
+            string(name);
+            d.depends.push_back(std::move(name));
+            skip_blank_lines();
+            if (p_ != end_ && *p_ == ',')
+                ++p_;
+            else if (p_ == end_ || *p_ != ']')
+                fail("expected ',' or ']'");
+        }
+    }
+
+    void property(BeanDefinition& d, std::string_view name) {
+        if (!d.bean)
+            fail("'type' must come before the properties of bean '" + d.name + "'");
+        const PluginType& type = d.bean->type();
+        const std::size_t i = type.index_of(name);
+        if (i == PluginType::npos)
+            fail("type '" + std::string(type.name()) + "' has no field '" + std::string(name) + "'");
+        if (assigned_[i])
+            fail("field '" + std::string(name) + "' given twice");
+        assigned_[i] = true;
+        const PluginType::Field& f = type.fields()[i];
+        if (f.kind == FieldKind::Other)
+            fail("field '" + std::string(name) + "' cannot be configured");
+        void* field = static_cast<std::byte*>(d.bean->data()) + f.offset;
+        switch (f.kind) {
+        case FieldKind::Bool: store<bool>(field, boolean()); break;
+        case FieldKind::Int8: store(field, integer<std::int8_t>()); break;
+        case FieldKind::Int16: store(field, integer<std::int16_t>()); break;
+        case FieldKind::Int32: store(field, integer<std::int32_t>()); break;
+        case FieldKind::Int64: store(field, integer<std::int64_t>()); break;
+        case FieldKind::UInt8: store(field, integer<std::uint8_t>()); break;
+        case FieldKind::UInt16: store(field, integer<std::uint16_t>()); break;
+        case FieldKind::UInt32: store(field, integer<std::uint32_t>()); break;
+        case FieldKind::UInt64: store(field, integer<std::uint64_t>()); break;
+        case FieldKind::Float: store(field, static_cast<float>(floating())); break;
+        case FieldKind::Double: store(field, floating()); break;
+        case FieldKind::String:
+            if (p_ == end_ || (*p_ != '"' && *p_ != '\''))
+                fail("field '" + std::string(name) + "' takes a string");
+            string(*std::launder(static_cast<std::string*>(field)));
+            break;
+        case FieldKind::Other: break;
+        }
+    }
+
+    template <class T>
+    static void store(void* field, T value) noexcept {
+        *std::launder(static_cast<T*>(field)) = value;
+    }
+
+    bool boolean() {
+        const std::string_view rest(p_, static_cast<std::size_t>(end_ - p_));
+        for (const bool v : {true, false}) {
+            const std::string_view word = v ? "true" : "false";
+            if (rest.starts_with(word) && (rest.size() == word.size() || !is_key_char(rest[word.size()]))) {
+                p_ += word.size();
+                return v;
+            }
+        }
+        fail("expected true or false");
+    }
+
+    /// The characters of a number token with `_` separators removed.
+    std::string_view number_token() {
+        const char* begin = p_;
+        std::size_t n = 0;
+        while (p_ != end_ && (is_key_char(*p_) || *p_ == '+' || *p_ == '.')) {
+            if (*p_ != '_') {
+                if (n == sizeof number_)
+                    fail("number too long");
+                number_[n++] = *p_;
+            }
+            ++p_;
+        }
+        if (p_ == begin)
+            fail("expected a number");
+        return {number_, n};
+    }
+
+    template <class T>
+    T integer() {
+        std::string_view s = number_token();
+        bool negative = false;
+        if (!s.empty() && (s[0] == '+' || s[0] == '-')) {
+            negative = s[0] == '-';
+            s.remove_prefix(1);
+        }
+        int base = 10;
+        if (s.size() > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'o' || s[1] == 'b')) {
+            base = s[1] == 'x' ? 16 : s[1] == 'o' ? 8 : 2;
+            s.remove_prefix(2);
+        }
+        std::uint64_t magnitude = 0;
+        const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), magnitude, base);
+        if (ec != std::errc() || end != s.data() + s.size() || s.empty())
+            fail(ec == std::errc::result_out_of_range ? "integer out of range" : "expected an integer");
+        using Limits = std::numeric_limits<T>;
+        if (negative) {
+            if constexpr (Limits::is_signed) {
+                if (magnitude <= static_cast<std::uint64_t>(Limits::max()) + 1)
+                    return static_cast<T>(-static_cast<std::int64_t>(magnitude - 1) - 1);
+            } else if (magnitude == 0) {
+                return 0;
+            }
+        } else if (magnitude <= static_cast<std::uint64_t>(Limits::max())) {
+            return static_cast<T>(magnitude);
+        }
+        fail("integer out of range");
+    }
+
+    double floating() {
+        std::string_view s = number_token();
+        const bool negative = !s.empty() && s[0] == '-';
+        if (!s.empty() && (s[0] == '+' || s[0] == '-'))
+            s.remove_prefix(1);
+        if (s == "inf")
+            return negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+        if (s == "nan")
+            return std::nan("");
+        double v = 0;
+        const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+        if (ec != std::errc() || end != s.data() + s.size())
+            fail("expected a number");
+        return negative ? -v : v;
+    }
+
+    void string(std::string& out) {
+        out.clear();
+        if (*p_ == '\'') {
+            const char* begin = ++p_;
+            while (p_ != end_ && *p_ != '\'' && *p_ != '\n')
+                ++p_;
+            if (p_ == end_ || *p_ != '\'')
+                fail("unterminated string");
+            out.assign(begin, p_++);
+            return;
+        }
+        basic_string(out);
+    }
+
+    void basic_string(std::string& out) {
+        ++p_;
+        for (;;) {
+            const char* begin = p_;
+            while (p_ != end_ && *p_ != '"' && *p_ != '\\' && *p_ != '\n')
+                ++p_;
+            out.append(begin, p_);
+            if (p_ == end_ || *p_ == '\n')
+                fail("unterminated string");
+            if (*p_++ == '"')
+                return;
+            if (p_ == end_)
+                fail("unterminated string");
+            switch (const char c = *p_++) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': utf8(out, hex(4)); break;
+            case 'U': utf8(out, hex(8)); break;
+            default: fail(std::string("unknown escape '\\") + c + "'");
+            }
+        }
+    }
+
+    std::uint32_t hex(int digits) {
+        if (end_ - p_ < digits)
+            fail("truncated escape");
+        std::uint32_t v = 0;
+        const auto [end, ec] = std::from_chars(p_, p_ + digits, v, 16);
+        if (ec != std::errc() || end != p_ + digits)
+            fail("bad escape");
+        p_ += digits;
+        return v;
+    }
+
+    void utf8(std::string& out, std::uint32_t c) {
+        if (c > 0x10ffff || (c >= 0xd800 && c <= 0xdfff))
+            fail("escape is not a Unicode scalar value");
+        if (c < 0x80) {
+            out += static_cast<char>(c);
+        } else if (c < 0x800) {
+            out += static_cast<char>(0xc0 | (c >> 6));
+            out += static_cast<char>(0x80 | (c & 0x3f));
+        } else if (c < 0x10000) {
+            out += static_cast<char>(0xe0 | (c >> 12));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (c & 0x3f));
+        } else {
+            out += static_cast<char>(0xf0 | (c >> 18));
+            out += static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (c & 0x3f));
+        }
+    }
+
+    const char* p_;
+    const char* end_;
+    const TypeRegistry& types_;
+    std::size_t line_ = 1;
+    std::vector<bool> assigned_;
+    char number_[64];
+};
+
+/// True if `a` and `b` hold the same configured values.  Fields of kind
+/// `Other` cannot be configured and are not compared.
+inline bool same_values(const DynamicBean& a, const DynamicBean& b) noexcept {
+    if (&a.type() != &b.type())
+        return false;
+    const auto* x = static_cast<const std::byte*>(a.data());
+    const auto* y = static_cast<const std::byte*>(b.data());
+    for (const PluginType::Field& f : a.type().fields()) {
+        if (f.kind == FieldKind::String) {
+            if (*std::launder(reinterpret_cast<const std::string*>(x + f.offset)) !=
+                *std::launder(reinterpret_cast<const std::string*>(y + f.offset)))
+                return false;
+        } else if (f.kind != FieldKind::Other && std::memcmp(x + f.offset, y + f.offset, f.size) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace detail
+
+/// Named beans defined by configuration.  Types come from a `TypeRegistry`:
+/// register built-in types with `types.add(*beans::c::type_info<T>())`, or
+/// load them from plugins.  Definitions are read from a subset of TOML:
+///
+///     [feed]                      # a bean called "feed"
+///     type = "MarketFeed"         # registered type name; comes first
+///     depends = ["clock"]         # optional: beans this one needs
+///     symbol = "AAPL"             # field values
+///     price = 101.5
+///     levels = 10
+///     enabled = true
+///
+/// Values are strings ("basic" with escapes, or 'literal'), integers
+/// (decimal, 0x, 0o, 0b, with `_` separators), floats (including inf and
+/// nan) and booleans.  Fields not mentioned keep their default values.
+///
+/// `reload()` swaps in a new configuration while the container is in use,
+/// rebuilding only the beans whose definitions changed and the beans that
+/// depend on them.  Every other bean keeps its instance.
+class Container {
+public:
+    using Listener = Function<void(const Container&, const BeanChange&)>;
+
+    explicit Container(const TypeRegistry& types) noexcept : types_(&types) {}
+
+    Container(const Container&) = delete;
+    Container& operator=(const Container&) = delete;
+
+    /// Adds the beans defined in `config`.  Throws `ConfigError` for
+    /// malformed input, unknown types or fields, names already in use,
+    /// unknown dependencies and dependency cycles; the container is then
+    /// unchanged.
+    void load(std::string_view config) {
+        std::vector<BeanDefinition> loaded = detail::ConfigParser(config, *types_).parse();
+        for (const BeanDefinition& d : loaded)
+            if (find(d.name))
+                throw ConfigError("bean '" + d.name + "' is already defined");
+        const std::size_t first = definitions_.size();
+        definitions_.reserve(first + loaded.size());
+        for (BeanDefinition& d : loaded)
+            definitions_.push_back(std::move(d));
+        try {
+            dependency_order(definitions_);
+        } catch (...) {
+            definitions_.resize(first);
+            throw;
+        }
+    }
+
+    /// Replaces the configuration with `config`, keeping every bean whose
+    /// definition (type, dependencies and values) is unchanged and whose
+    /// dependencies are all kept too.  Beans whose definitions changed, and
+    /// the beans depending on them, get new instances.  Listeners then hear
+    /// about removals, dependents first, followed by additions and
+    /// replacements, dependencies first, so a listener rewiring a dependent
+    /// finds its dependencies already in place.
+    ///
+    /// Throws `ConfigError` as `load()` does, leaving the container
+    /// unchanged.  References to replaced and removed beans become invalid
+    /// unless the beans were shared with `share()`.  Returns the changes.
+    std::vector<BeanChange> reload(std::string_view config) {
+        std::vector<BeanDefinition> next = detail::ConfigParser(config, *types_).parse();
+        const std::vector<std::size_t> order = dependency_order(next);
+        const std::size_t n = next.size();
+
+        // Diff by name: keep the old instance of unchanged beans.
+        enum : std::uint8_t { Same, Added, Changed, Rebuilt };
+        std::vector<std::uint8_t> state(n, Same);
+        std::vector<std::shared_ptr<DynamicBean>> fresh(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const BeanDefinition* old = definition(next[i].name);
+            if (!old)
+                state[i] = Added;
+            else if (old->depends != next[i].depends || !detail::same_values(*old->bean, *next[i].bean))
+                state[i] = Changed;
+            else
+                fresh[i] = std::exchange(next[i].bean, old->bean);
+        }
+        // Walking in dependency order, a kept bean is rebuilt if anything it
+        // depends on is new.
+        const auto index_of = [&](const std::string& name) {
+            const std::uint64_t h = name_hash(name);
+            std::size_t j = 0;
+            while (next[j].hash != h || next[j].name != name)
+                ++j;
+            return j;
+        };
+        for (const std::size_t i : order) {
+            if (state[i] != Same)
+                continue;
+            for (const std::string& dep : next[i].depends) {
+                if (state[index_of(dep)] != Same) {
+                    state[i] = Rebuilt;
+                    next[i].bean = std::move(fresh[i]);
+                    break;
+                }
+            }
+        }
+
+        std::vector<BeanChange> changes;
+        for (const std::size_t i : dependency_order(definitions_) | std::views::reverse) {
+            const BeanDefinition& old = definitions_[i];
+            if (!std::any_of(next.begin(), next.end(),
+                             [&](const BeanDefinition& d) { return d.hash == old.hash && d.name == old.name; }))
+                changes.push_back({BeanChange::Kind::Removed, old.name});
+        }
+        for (const std::size_t i : order) {
+            static constexpr BeanChange::Kind kinds[] = {BeanChange::Kind::Added, BeanChange::Kind::Added,
+                                                         BeanChange::Kind::Changed, BeanChange::Kind::Rebuilt};
+            if (state[i] != Same)
+                changes.push_back({kinds[state[i]], next[i].name});
+        }
+
+        definitions_ = std::move(next);
+        for (const BeanChange& change : changes)
+            listeners_.notify(*this, change);
+        return changes;
+    }
+
+    /// Reads and reloads a configuration file; see `reload()`.
+    std::vector<BeanChange> reload_file(const std::string& path) { return reload(read_file(path)); }
+
+    ListenerId subscribe(Listener listener) { return listeners_.subscribe(std::move(listener)); }
+    bool unsubscribe(ListenerId id) { return listeners_.unsubscribe(id); }
+
+    /// Reads and loads a configuration file; throws `ConfigError` if it
+    /// cannot be read.
+    void load_file(const std::string& path) { load(read_file(path)); }
+
+    std::size_t size() const noexcept { return definitions_.size(); }
+    std::span<const BeanDefinition> definitions() const noexcept { return definitions_; }
+
+    /// The bean called `name`, or nullptr.
+    DynamicBean* find(const FieldName& name) noexcept {
+        const BeanDefinition* d = definition(name);
+        return d ? d->bean.get() : nullptr;
+    }
+    const DynamicBean* find(const FieldName& name) const noexcept {
+        const BeanDefinition* d = definition(name);
+        return d ? d->bean.get() : nullptr;
+    }
+
+    /// The bean called `name` as a `T`, or nullptr if there is none or it is
+    /// of another type.
+    template <Reflectable T>
+    T* find(const FieldName& name) noexcept {
+        DynamicBean* bean = find(name);
+        return bean && bean->type().is<T>() ? static_cast<T*>(bean->data()) : nullptr;
+    }
+
+    /// Shared ownership of the bean called `name`, or null.  The bean stays
+    /// alive while shared, even after a reload replaces or removes it.
+    std::shared_ptr<DynamicBean> share(const FieldName& name) const noexcept {
+        const BeanDefinition* d = definition(name);
+        return d ? d->bean : nullptr;
+    }
+
+    /// Like `find`, but throws `std::out_of_range` instead of returning null.
+    DynamicBean& get(const FieldName& name) {
+        if (DynamicBean* bean = find(name))
+            return *bean;
+        throw std::out_of_range("no bean '" + std::string(name.text) + "'");
+    }
+    template <Reflectable T>
+    T& get(const FieldName& name) {
+        if (T* bean = find<T>(name))
+            return *bean;
+        throw std::out_of_range("no bean '" + std::string(name.text) + "' of type " + std::string(type_name_v<T>));
+    }
+
+    const BeanDefinition* definition(const FieldName& name) const noexcept {
+        return find_in(definitions_, name);
+    }
+
+private:
+    static std::string read_file(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            throw ConfigError("cannot open '" + path + "'");
+        std::ostringstream text;
+        text << in.rdbuf();
+        return std::move(text).str();
+    }
+
+    static const BeanDefinition* find_in(std::span<const BeanDefinition> definitions,
+                                         const FieldName& name) noexcept {
+        for (const BeanDefinition& d : definitions)
+            if (d.hash == name.hash && d.name == name.text)
+                return &d;
+        return nullptr;
+    }
+
+    /// Indices of `definitions` with every bean after the beans it depends
+    /// on (iterative depth-first search).  Throws `ConfigError` for unknown
+    /// dependencies and cycles.
+    static std::vector<std::size_t> dependency_order(std::span<const BeanDefinition> definitions) {
+        const std::size_t n = definitions.size();
+        std::vector<std::size_t> order;
+        order.reserve(n);
+        std::vector<std::uint8_t> state(n, 0);  // 0 new, 1 on the stack, 2 done.
+        std::vector<std::pair<std::size_t, std::size_t>> stack;
+        for (std::size_t root = 0; root < n; ++root) {
+            if (state[root])
+                continue;
+            stack.push_back({root, 0});
+            state[root] = 1;
+            while (!stack.empty()) {
+                auto& [i, next] = stack.back();
+                const BeanDefinition& d = definitions[i];
+                if (next == d.depends.size()) {
+                    state[i] = 2;
+                    order.push_back(i);
+                    stack.pop_back();
+                    continue;
+                }
+                const BeanDefinition* dep = find_in(definitions, d.depends[next++]);
+                if (!dep)
+                    throw ConfigError("bean '" + d.name + "' depends on unknown bean '" + d.depends[next - 1] + "'");
+                const auto j = static_cast<std::size_t>(dep - definitions.data());
+                if (state[j] == 1)
+                    throw ConfigError("dependency cycle through bean '" + dep->name + "'");
+                if (state[j] == 0) {
+                    state[j] = 1;
+                    stack.push_back({j, 0});
+                }
+            }
+        }
+        return order;
+    }
+
+    const TypeRegistry* types_;
+    std::vector<BeanDefinition> definitions_;
+    detail::LazyListenerList<const Container&, const BeanChange&> listeners_;
+};
+
+}  // namespace beans
@@ -0,0 +1,554 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "detail/sparse.hpp"
+#include "fixed_string.hpp"
+#include "reflect.hpp"
+#include "sampling.hpp"
+
+namespace beans {
+
+/// Field option: keep this field with the other hot fields at the start of
+/// the object, so frequently accessed fields share cache lines.
+struct Hot {};
+
+/// Field option: listeners bound at the declaration site.  `Bean::set<I>()`
+/// calls `Slot{}(bean, old_value, new_value)` for each slot directly, with no
+/// type erasure, so the calls inline.  Slots must be default constructible.
+template <class... Slots>
+struct Notify {};
+
+/// Field option: store the field out of line, only while it differs from its
+/// default (a value-initialised `T`).  For beans with many properties that
+/// are mostly left at their defaults: unset sparse fields cost nothing, and
+/// all of a bean's sparse fields together cost one pointer until one is set.
+/// Reads of an unset field return the default; taking a mutable reference
+/// (non-const `get`) stores the field, and that reference is only valid until
+/// another sparse field of the same bean is set.
+struct Sparse {};
+
+/// Field option: the field may be null, like a `std::optional<T>`, but its
+/// presence is a bit in a mask shared by all of the bean's nullable fields
+/// rather than a flag (and its padding) next to each value.  Use `has_value`,
+/// `get_optional` and `reset` for optional semantics, and `set` with a value,
+/// an optional or `std::nullopt`.  A null field holds a value-initialised `T`,
+/// which is what plain `get` and reflection see.
+struct Nullable {};
+
+/// Field option: the field's number in tagged wire formats such as protobuf.
+/// Fields without one take the number after the previous field's.
+template <std::uint32_t N>
+    requires(N >= 1 && N <= 536870911)
+struct Number {};
+
+namespace detail {
+
+template <class... Options>
+struct notify_slots {
+    using type = std::tuple<>;
+};
+
+template <class... Slots, class... Rest>
+struct notify_slots<Notify<Slots...>, Rest...> {
+    using type = decltype(std::tuple_cat(std::declval<std::tuple<Slots...>>(),
+                                         std::declval<typename notify_slots<Rest...>::type>()));
+};
+
+template <class Option, class... Rest>
+struct notify_slots<Option, Rest...> : notify_slots<Rest...> {};
+
+template <class Option>
+inline constexpr std::uint32_t number_option = 0;
+
+template <std::uint32_t N>
+inline constexpr std::uint32_t number_option<Number<N>> = N;
+
+}  // namespace detail
+
+/// Declares one field of a `Bean`: its name, its type and options.
+template <FixedString Name, class T, class... Options>
+struct Field {
+    using type = T;
+    static constexpr std::string_view name = Name;
+    static constexpr bool hot = (std::is_same_v<Options, Hot> || ...);
+    static constexpr bool sparse = (std::is_same_v<Options, Sparse> || ...);
+    static constexpr bool nullable = (std::is_same_v<Options, Nullable> || ...);
+    static_assert(!(sparse && nullable), "a field cannot be both Sparse and Nullable");
+    static constexpr std::uint32_t number = (detail::number_option<Options> + ... + 0);
+    using slots = typename detail::notify_slots<Options...>::type;
+    /// What the bean's constructor takes for this field.
+    using param_type = std::conditional_t<nullable, std::optional<T>, T>;
+};
+
+namespace detail {
+
+struct FieldLayout {
+    bool hot;
+    std::size_t align;
+    bool sparse = false;
+};
+
+/// Storage order for fields: hot fields first, then by decreasing alignment,
+/// declaration order breaking ties.  Decreasing alignment leaves padding only
+/// at the end of each group.  Sparse fields go last, in declaration order;
+/// they are not stored inline.  Returns declared indices in storage order.
+template <std::size_t N>
+constexpr std::array<std::size_t, N> storage_order(const std::array<FieldLayout, N>& fields) {
+    std::array<std::size_t, N> order{};
+    for (std::size_t i = 0; i < N; ++i)
+        order[i] = i;
+    auto before = [&](std::size_t a, std::size_t b) {
+        if (fields[a].sparse != fields[b].sparse)
+            return fields[b].sparse;
+        if (fields[a].sparse)
+            return false;
+        if (fields[a].hot != fields[b].hot)
+            return fields[a].hot;
+        return fields[a].align > fields[b].align;
+    };
+    // Insertion sort: stable and usable in constant expressions.
+    for (std::size_t i = 1; i < N; ++i)
+        for (std::size_t j = i; j > 0 && before(order[j], order[j - 1]); --j)
+            std::swap(order[j], order[j - 1]);
+    return order;
+}
+
+template <std::size_t N>
+constexpr std::array<std::size_t, N> invert(const std::array<std::size_t, N>& order) {
+    std::array<std::size_t, N> slots{};
+    for (std::size_t i = 0; i < N; ++i)
+        slots[order[i]] = i;
+    return slots;
+}
+
+struct from_declared_t {};
+
+/// Presence bits for a bean's nullable fields, in the narrowest word that
+/// holds them, so the mask can fill padding among the fields.
+template <std::size_t N>
+struct NullMask {
+    using word = std::conditional_t<
+        (N <= 8), std::uint8_t,
+        std::conditional_t<(N <= 16), std::uint16_t, std::conditional_t<(N <= 32), std::uint32_t, std::uint64_t>>>;
+    static constexpr std::size_t word_bits = 8 * sizeof(word);
+    static constexpr std::size_t words = (N + word_bits - 1) / word_bits;
+
+    word bits[words]{};
+
+    constexpr bool test(std::size_t i) const noexcept { return (bits[i / word_bits] >> (i % word_bits)) & 1u; }
+    constexpr void set(std::size_t i) noexcept { bits[i / word_bits] |= static_cast<word>(word{1} << (i % word_bits)); }
+    constexpr void clear(std::size_t i) noexcept {
+        bits[i / word_bits] &= static_cast<word>(~(word{1} << (i % word_bits)));
+    }
+
+    friend constexpr bool operator==(const NullMask&, const NullMask&) = default;
+};
+
+/// Stands in for the null mask in a bean's storage layout.
+template <std::size_t N>
+struct MaskField {
+    using type = NullMask<N>;
+};
+
+/// Fields in storage order, nested one per level.  `Order` maps a storage
+/// position back to the declared index, used when constructing from values
+/// given in declaration order.
+template <auto Order, std::size_t K, class... Ts>
+struct Storage {
+    friend constexpr bool operator==(const Storage&, const Storage&) = default;
+};
+
+template <auto Order, std::size_t K, class T, class... Rest>
+struct Storage<Order, K, T, Rest...> {
+    [[no_unique_address]] T value{};
+    [[no_unique_address]] Storage<Order, K + 1, Rest...> rest{};
+
+    constexpr Storage() = default;
+
+    template <class Tuple>
+    constexpr Storage(from_declared_t tag, Tuple& declared)
+        : value(std::move(std::get<Order[K]>(declared))), rest(tag, declared) {}
+
+    friend constexpr bool operator==(const Storage&, const Storage&) = default;
+};
+
+template <auto Order, std::size_t K>
+struct Storage<Order, K> {
+    constexpr Storage() = default;
+    template <class Tuple>
+    constexpr Storage(from_declared_t, Tuple&) {}
+
+    friend constexpr bool operator==(const Storage&, const Storage&) = default;
+};
+
+template <class T>
+inline constexpr bool is_optional_v = false;
+
+template <class T>
+inline constexpr bool is_optional_v<std::optional<T>> = true;
+
+template <std::size_t K, class S>
+constexpr auto& storage_get(S& storage) noexcept {
+    if constexpr (K == 0)
+        return storage.value;
+    else
+        return storage_get<K - 1>(storage.rest);
+}
+
+template <auto Order, class Declared, class Seq>
+struct storage_for;
+
+template <auto Order, class... Fields, std::size_t... K>
+struct storage_for<Order, std::tuple<Fields...>, std::index_sequence<K...>> {
+    using type =
+        Storage<Order, 0, typename std::tuple_element_t<Order[K], std::tuple<Fields...>>::type...>;
+};
+
+/// Side table for the fields at storage positions `Inline + K`, which are the
+/// sparse ones.
+template <auto Order, std::size_t Inline, class Declared, class Seq>
+struct sparse_for;
+
+template <auto Order, std::size_t Inline, class... Fields, std::size_t... K>
+struct sparse_for<Order, Inline, std::tuple<Fields...>, std::index_sequence<K...>> {
+    using type = SparseStore<typename std::tuple_element_t<Order[Inline + K], std::tuple<Fields...>>::type...>;
+};
+
+}  // namespace detail
+
+/// Declares a bean from a list of fields:
+///
+///     struct Trade : beans::Bean<Trade,
+///                                beans::Field<"symbol", std::string>,
+///                                beans::Field<"price", double, beans::Hot>,
+///                                beans::Field<"qty", std::int32_t>> {};
+///
+/// The library picks the storage order (hot fields first, then by decreasing
+/// alignment) to minimise padding, while reflection, descriptors and anything
+/// built on them keep seeing the fields in declaration order.
+template <class Derived, class... Fields>
+class Bean {
+public:
+    static constexpr std::size_t field_count = sizeof...(Fields);
+
+private:
+    using declared = std::tuple<Fields...>;
+
+    static constexpr std::size_t sparse_count = (std::size_t{Fields::sparse} + ... + 0);
+    static constexpr std::size_t nullable_count = (std::size_t{Fields::nullable} + ... + 0);
+
+    // The null mask, if any, is laid out like one more field after the
+    // declared ones.
+    using mask_type = detail::NullMask<nullable_count>;
+    using layout = std::conditional_t<(nullable_count > 0), std::tuple<Fields..., detail::MaskField<nullable_count>>,
+                                      declared>;
+    static constexpr std::size_t layout_count = std::tuple_size_v<layout>;
+    static constexpr std::size_t inline_count = layout_count - sparse_count;
+
+    static constexpr std::array<std::size_t, layout_count> order_ = [] {
+        std::array<detail::FieldLayout, layout_count> fields{};
+        std::size_t i = 0;
+        ((fields[i++] = {Fields::hot, alignof(typename Fields::type), Fields::sparse}), ...);
+        if constexpr (nullable_count > 0)
+            fields[field_count] = {false, alignof(mask_type)};
+        return detail::storage_order(fields);
+    }();
+    static constexpr std::array<std::size_t, layout_count> slots_ = detail::invert(order_);
+
+    template <std::size_t I>
+    static constexpr bool is_sparse = std::tuple_element_t<I, declared>::sparse;
+    template <std::size_t I>
+    static constexpr bool is_nullable = std::tuple_element_t<I, declared>::nullable;
+
+    /// Bit of nullable field `I` in the null mask.
+    template <std::size_t I>
+    static constexpr std::size_t null_bit = [] {
+        std::size_t bit = 0;
+        std::size_t i = 0;
+        ((i++ < I ? bit += Fields::nullable : 0), ...);
+        return bit;
+    }();
+
+    using storage_type =
+        typename detail::storage_for<order_, layout, std::make_index_sequence<inline_count>>::type;
+    using sparse_type = typename detail::sparse_for<order_, inline_count, declared,
+                                                    std::make_index_sequence<sparse_count>>::type;
+
+public:
+    template <std::size_t I>
+    using field_type = typename std::tuple_element_t<I, declared>::type;
+
+    /// Declared index of the field called `Name`; fails to compile if unknown.
+    template <FixedString Name>
+    static constexpr std::size_t index_of = [] {
+        constexpr std::size_t index = [] {
+            std::size_t i = 0;
+            ((Fields::name == Name.view() ? false : (++i, true)) && ...);
+            return i;
+        }();
+        static_assert(index < field_count, "bean has no field with this name");
+        return index;
+    }();
+
+    /// Storage position of declared field `I`; exposed for layout inspection.
+    template <std::size_t I>
+        requires(!is_sparse<I>)
+    static constexpr std::size_t storage_index = slots_[I];
+
+    /// Number of sparse fields currently holding a non-default value.
+    std::size_t sparse_size() const noexcept { return sparse_.size(); }
+
+    constexpr Bean() = default;
+
+    /// Initialises every field, in declaration order.  Nullable fields take
+    /// a `std::optional`.
+    constexpr Bean(typename Fields::param_type... values)
+        requires(field_count > 0)
+        : Bean(detail::from_declared_t{},
+               layout_values(std::tuple<typename Fields::param_type...>(std::move(values)...),
+                             std::make_index_sequence<field_count>{})) {}
+
+    /// Mutable access, for writing.  For a nullable field this makes it
+    /// non-null, as the reference may be used to write it; read through the
+    /// const overload, which never changes presence.
+    template <std::size_t I>
+    constexpr field_type<I>& get() noexcept(!is_sparse<I>) {
+        if constexpr (is_sparse<I>) {
+            return sparse_.template ref<slots_[I] - inline_count>();
+        } else {
+            if constexpr (is_nullable<I>)
+                mask().set(null_bit<I>);
+            return detail::storage_get<slots_[I]>(storage_);
+        }
+    }
+    template <std::size_t I>
+    constexpr const field_type<I>& get() const noexcept {
+        if constexpr (is_sparse<I>)
+            return sparse_.template get<slots_[I] - inline_count>();
+        else
+            return detail::storage_get<slots_[I]>(storage_);
+    }
+
+    /// Field access by name, checked and resolved at compile time:
+    /// `trade.get<"price">()` compiles to the same access as `get<1>()`.
+    template <FixedString Name>
+    constexpr auto& get() noexcept(!is_sparse<index_of<Name>>) {
+        return get<index_of<Name>>();
+    }
+    template <FixedString Name>
+    constexpr const auto& get() const noexcept {
+        return get<index_of<Name>>();
+    }
+
+    /// Whether nullable field `I` holds a value.
+    template <std::size_t I>
+        requires is_nullable<I>
+    constexpr bool has_value() const noexcept {
+        return mask().test(null_bit<I>);
+    }
+    template <FixedString Name>
+    constexpr bool has_value() const noexcept {
+        return has_value<index_of<Name>>();
+    }
+
+    /// Nullable field `I` as an optional.
+    template <std::size_t I>
+        requires is_nullable<I>
+    constexpr std::optional<field_type<I>> get_optional() const {
+        if (!has_value<I>())
+            return std::nullopt;
+        return detail::storage_get<slots_[I]>(storage_);
+    }
+    template <FixedString Name>
+    constexpr auto get_optional() const {
+        return get_optional<index_of<Name>>();
+    }
+
+    /// Makes nullable field `I` null; same as `set<I>(std::nullopt)`.
+    template <std::size_t I>
+        requires is_nullable<I>
+    constexpr void reset() {
+        set<I>(std::nullopt);
+    }
+    template <FixedString Name>
+    constexpr void reset() {
+        reset<index_of<Name>>();
+    }
+
+    /// Assigns declared field `I` and, if the value changed, calls the slots
+    /// the field was declared with (see `Notify`).  Setting a sparse field to
+    /// its default releases its entry.  A nullable field also takes an
+    /// optional or `std::nullopt`, and its slots receive optionals.
+    template <std::size_t I, class V>
+    constexpr void set(V&& value) {
+        using T = field_type<I>;
+        using slots = typename std::tuple_element_t<I, declared>::slots;
+        if constexpr (is_nullable<I>) {
+            if constexpr (std::tuple_size_v<slots> == 0) {
+                store_nullable<I>(std::forward<V>(value));
+            } else {
+                std::optional<T> old = get_optional<I>();
+                if constexpr (std::equality_comparable<T>) {
+                    if (old == value)
+                        return;
+                }
+                sampling::ScopedSetter timer(beans_traits::name, std::tuple_element_t<I, declared>::name,
+                                             std::tuple_size_v<slots>);
+                store_nullable<I>(std::forward<V>(value));
+                notify(static_cast<Derived&>(*this), old, get_optional<I>(), static_cast<slots*>(nullptr));
+            }
+        } else if constexpr (is_sparse<I>) {
+            constexpr std::size_t key = slots_[I] - inline_count;
+            if constexpr (std::tuple_size_v<slots> == 0) {
+                sparse_.template set<key>(std::forward<V>(value));
+            } else {
+                const T& field = sparse_.template get<key>();
+                if constexpr (std::equality_comparable<T>) {
+                    if (field == value)
+                        return;
+                }
+                sampling::ScopedSetter timer(beans_traits::name, std::tuple_element_t<I, declared>::name,
+                                             std::tuple_size_v<slots>);
+                T old = field;
+                sparse_.template set<key>(std::forward<V>(value));
+                notify(static_cast<Derived&>(*this), old, sparse_.template get<key>(),
+                       static_cast<slots*>(nullptr));
+            }
+        } else {
+            T& field = get<I>();
+            if constexpr (std::tuple_size_v<slots> == 0) {
+                field = std::forward<V>(value);
+            } else {
+                if constexpr (std::equality_comparable<T>) {
+                    if (field == value)
+                        return;
+                }
+                sampling::ScopedSetter timer(beans_traits::name, std::tuple_element_t<I, declared>::name,
+                                             std::tuple_size_v<slots>);
+                T old = std::exchange(field, std::forward<V>(value));
+                notify(static_cast<Derived&>(*this), old, field, static_cast<slots*>(nullptr));
+            }
+        }
+    }
+
+    template <FixedString Name, class V>
+    constexpr void set(V&& value) {
+        set<index_of<Name>>(std::forward<V>(value));
+    }
+
+    friend constexpr bool operator==(const Bean&, const Bean&) = default;
+
+    struct beans_traits {
+        static constexpr std::size_t size = field_count;
+        static constexpr std::string_view name = detail::type_name<Derived>();
+
+        template <std::size_t I>
+        static constexpr std::string_view field_name = std::tuple_element_t<I, declared>::name;
+
+        template <std::size_t I>
+        static constexpr std::uint32_t field_number = std::tuple_element_t<I, declared>::number;
+
+        template <std::size_t I>
+        static constexpr bool field_addressable = !is_sparse<I>;
+
+        template <std::size_t I>
+        static constexpr bool field_nullable = is_nullable<I>;
+
+        /// Size of the bean's own storage, null mask and sparse side table
+        /// included; a derived class bigger than this has members of its own.
+        static constexpr std::size_t storage_size() noexcept { return sizeof(Bean); }
+
+        template <std::size_t I>
+        static constexpr auto& get(Bean& bean) noexcept(!is_sparse<I>) {
+            return bean.template get<I>();
+        }
+        template <std::size_t I>
+        static constexpr const auto& get(const Bean& bean) noexcept {
+            return bean.template get<I>();
+        }
+    };
+
+private:
+    template <class T, class... Slots>
+    static constexpr void notify(Derived& bean, const T& old, const T& now, std::tuple<Slots...>*) {
+        (Slots{}(bean, old, now), ...);
+    }
+
+    constexpr mask_type& mask() noexcept {
+        return detail::storage_get<slots_[field_count]>(storage_);
+    }
+    constexpr const mask_type& mask() const noexcept {
+        return detail::storage_get<slots_[field_count]>(storage_);
+    }
+
+    /// Writes nullable field `I` from a value, an optional or `std::nullopt`.
+    /// A null field is reset to its default so equality stays memberwise.
+    template <std::size_t I, class V>
+    constexpr void store_nullable(V&& value) {
+        using T = field_type<I>;
+        T& field = detail::storage_get<slots_[I]>(storage_);
+        if constexpr (std::is_same_v<std::remove_cvref_t<V>, std::nullopt_t>) {
+            field = T{};
+            mask().clear(null_bit<I>);
+        } else if constexpr (detail::is_optional_v<std::remove_cvref_t<V>>) {
+            if (value) {
+                field = *std::forward<V>(value);
+                mask().set(null_bit<I>);
+            } else {
+                field = T{};
+                mask().clear(null_bit<I>);
+            }
+        } else {
+            field = std::forward<V>(value);
+            mask().set(null_bit<I>);
+        }
+    }
+
+    /// Constructor arguments in layout order: nullable fields unwrapped, and
+    /// their presence bits appended as the mask.
+    template <std::size_t... I>
+    static constexpr auto layout_values(std::tuple<typename Fields::param_type...>&& values,
+                                        std::index_sequence<I...>) {
+        if constexpr (nullable_count == 0) {
+            return std::tuple<typename Fields::type...>(std::move(std::get<I>(values))...);
+        } else {
+            mask_type mask;
+            auto unwrap = [&]<std::size_t J>(auto& value) -> field_type<J> {
+                if constexpr (is_nullable<J>) {
+                    if (!value)
+                        return field_type<J>{};
+                    mask.set(null_bit<J>);
+                    return std::move(*value);
+                } else {
+                    return std::move(value);
+                }
+            };
+            // Braced initialisation evaluates in order, so the mask is
+            // complete when it is copied.
+            return std::tuple<typename Fields::type..., mask_type>{
+                unwrap.template operator()<I>(std::get<I>(values))..., mask};
+        }
+    }
+
+    template <class Tuple>
+    constexpr Bean(detail::from_declared_t tag, Tuple&& declared_values)
+        : storage_(tag, declared_values) {
+        [&]<std::size_t... K>(std::index_sequence<K...>) {
+            (sparse_.template set<K>(std::move(std::get<order_[inline_count + K]>(declared_values))), ...);
+        }(std::make_index_sequence<sparse_count>{});
+    }
+
+    storage_type storage_;
+    [[no_unique_address]] sparse_type sparse_;
+};
+
+}  // namespace beans
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace beans {
+
+/// Runtime category of a field, enough for codecs and foreign bindings to
+/// interpret the bytes behind `FieldDescriptor::address`.
+enum class FieldKind : std::uint8_t {
+    Bool,
+    Int8,
+    Int16,
+    Int32,
+    Int64,
+    UInt8,
+    UInt16,
+    UInt32,
+    UInt64,
+    Float,
+    Double,
+    String,  ///< std::string
+    Other,   ///< Anything else; only reachable through typed C++ access.
+};
+
+template <class T>
+constexpr FieldKind field_kind_of() noexcept {
+    using U = std::remove_cv_t<T>;
+    if constexpr (std::is_same_v<U, bool>)
+        return FieldKind::Bool;
+    else if constexpr (std::is_integral_v<U>) {
+        constexpr bool is_signed = std::is_signed_v<U>;
+        if constexpr (sizeof(U) == 1)
+            return is_signed ? FieldKind::Int8 : FieldKind::UInt8;
+        else if constexpr (sizeof(U) == 2)
+            return is_signed ? FieldKind::Int16 : FieldKind::UInt16;
+        else if constexpr (sizeof(U) == 4)
+            return is_signed ? FieldKind::Int32 : FieldKind::UInt32;
+        else if constexpr (sizeof(U) == 8)
+            return is_signed ? FieldKind::Int64 : FieldKind::UInt64;
+        else
+            return FieldKind::Other;
+    } else if constexpr (std::is_same_v<U, float>)
+        return FieldKind::Float;
+    else if constexpr (std::is_same_v<U, double>)
+        return FieldKind::Double;
+    else if constexpr (std::is_same_v<U, std::string>)
+        return FieldKind::String;
+    else
+        return FieldKind::Other;
+}
+
+template <class T>
+inline constexpr FieldKind field_kind_v = field_kind_of<T>();
+
+/// 64-bit FNV-1a hash of a field name; stable across builds and platforms.
+constexpr std::uint64_t name_hash(std::string_view name) noexcept {
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    for (const char c : name) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+/// A field name with its hash computed up front.  Declared `constexpr`, the
+/// hash is computed at compile time and runtime lookups skip hashing:
+///
+///     constexpr beans::FieldName price{"price"};
+///     descriptor.find(price);
+struct FieldName {
+    std::string_view text;
+    std::uint64_t hash;
+
+    constexpr FieldName(std::string_view name) noexcept : text(name), hash(name_hash(name)) {}
+    constexpr FieldName(const char* name) noexcept : FieldName(std::string_view(name)) {}
+    FieldName(const std::string& name) noexcept : FieldName(std::string_view(name)) {}
+};
+
+/// Describes one field of a bean type, in declaration order.
+struct FieldDescriptor {
+    std::string_view name;
+    std::uint64_t hash = 0;  ///< `name_hash(name)`
+    FieldKind kind = FieldKind::Other;
+    std::size_t index = 0;
+    std::size_t size = 0;
+    std::size_t align = 0;
+    /// Returns the address of this field inside the bean at `bean`, for
+    /// writing; null for fields of kind `Other` that have no fixed address.
+    void* (*address)(void* bean) noexcept = nullptr;
+    /// Field number for tagged wire formats such as protobuf; 0 if the
+    /// descriptor predates field numbers, meaning `index + 1`.
+    std::uint32_t number = 0;
+    /// Returns the address of this field's value for reading.  Unlike
+    /// `address` it never changes the bean: a nullable field stays null.
+    /// Null if the descriptor predates it, in which case `address` is used.
+    const void* (*read)(const void* bean) noexcept = nullptr;
+
+    /// The field's value in `bean`, without changing the bean.
+    const void* get(const void* bean) const noexcept {
+        return read ? read(bean) : address(const_cast<void*>(bean));
+    }
+
+    /// Typed access; `T` must be the field's declared type.
+    template <class T>
+    T& ref(void* bean) const noexcept {
+        return *static_cast<T*>(address(bean));
+    }
+    template <class T>
+    const T& ref(const void* bean) const noexcept {
+        return *static_cast<const T*>(get(bean));
+    }
+};
+
+/// Describes a bean type: its name and its fields in declaration order.
+struct BeanDescriptor {
+    std::string_view name;
+    std::span<const FieldDescriptor> fields;
+    std::size_t size = 0;
+    std::size_t align = 0;
+    /// Field indices ordered by hash, for binary search; may be empty, in
+    /// which case lookups scan `fields`.
+    std::span<const std::uint16_t> by_hash;
+
+    /// Returns the field called `field_name`, or nullptr.
+    constexpr const FieldDescriptor* find(const FieldName& field_name) const noexcept {
+        if (by_hash.empty()) {
+            for (const auto& f : fields)
+                if (f.hash == field_name.hash && f.name == field_name.text)
+                    return &f;
+            return nullptr;
+        }
+        std::size_t lo = 0, hi = by_hash.size();
+        while (lo < hi) {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            if (fields[by_hash[mid]].hash < field_name.hash)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        for (; lo < by_hash.size() && fields[by_hash[lo]].hash == field_name.hash; ++lo)
+            if (fields[by_hash[lo]].name == field_name.text)
+                return &fields[by_hash[lo]];
+        return nullptr;
+    }
+};
+
+}  // namespace beans
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace beans::detail {
+
+/// Bulk element kernels for contiguous storage.  Arithmetic element types go
+/// through loops blocked into fixed runs of one 64-byte cache line: the inner
+/// loop has a constant trip count, so GCC and Clang turn it into SSE/AVX/NEON
+/// code at -O2 (a plain loop with a runtime bound is only vectorised at -O3).
+/// Other types use the standard algorithms.
+template <class T>
+inline constexpr bool simd_kernel_v = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+template <class T>
+inline constexpr std::size_t simd_block = 64 / sizeof(T);
+
+template <class T>
+void fill_n(T* p, std::size_t n, const T& value) {
+    if constexpr (simd_kernel_v<T>) {
+        const T v = value;
+        std::size_t i = 0;
+        for (; i + simd_block<T> <= n; i += simd_block<T>)
+            for (std::size_t j = 0; j < simd_block<T>; ++j)
+                p[i + j] = v;
+        for (; i < n; ++i)
+            p[i] = v;
+    } else {
+        std::fill_n(p, n, value);
+    }
+}
+
+/// Copies `n` elements from `src` to `dst`; the ranges may overlap.
+template <class T>
+void copy_n(T* dst, const T* src, std::size_t n) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        if (n)
+            std::memmove(dst, src, n * sizeof(T));
+    } else if (dst <= src || dst >= src + n) {
+        std::copy(src, src + n, dst);
+    } else {
+        std::copy_backward(src, src + n, dst + n);
+    }
+}
+
+/// Replaces each of the `n` elements at `p` with `f(element)`.
+template <class T, class F>
+void transform_n(T* p, std::size_t n, F& f) {
+    if constexpr (simd_kernel_v<T>) {
+        std::size_t i = 0;
+        for (; i + simd_block<T> <= n; i += simd_block<T>)
+            for (std::size_t j = 0; j < simd_block<T>; ++j)
+                p[i + j] = static_cast<T>(f(p[i + j]));
+        for (; i < n; ++i)
+            p[i] = static_cast<T>(f(p[i]));
+    } else {
+        for (std::size_t i = 0; i < n; ++i)
+            p[i] = f(std::as_const(p[i]));
+    }
+}
+
+}  // namespace beans::detail
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "../function.hpp"
+
+namespace beans {
+
+/// Handle returned by `subscribe()`, used to remove the listener again.
+using ListenerId = std::uint64_t;
+
+namespace detail {
+
+/// Listener registry shared by the observable types.
+///
+/// Listeners may subscribe or unsubscribe from inside a notification.
+/// Listeners added during a notification are first called on the next one;
+/// removed listeners are skipped immediately and compacted afterwards, so a
+/// running listener is never moved or destroyed under its own feet.
+template <class... Args>
+class ListenerList {
+public:
+    using Listener = Function<void(Args...)>;
+
+    ListenerId subscribe(Listener listener) {
+        const ListenerId id = ++last_id_;
+        // Never grow `entries_` while it is being iterated: the listener that
+        // is currently running lives inside it.
+        (firing_ ? pending_ : entries_).push_back({id, std::move(listener)});
+        ++count_;
+        return id;
+    }
+
+    /// Removes the listener registered under `id`; returns false if unknown.
+    bool unsubscribe(ListenerId id) {
+        for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+            if (it->id == id) {
+                pending_.erase(it);
+                --count_;
+                return true;
+            }
+        }
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->id == id && it->active) {
+                if (firing_)
+                    it->active = false;  // Compacted once the notification ends.
+                else
+                    entries_.erase(it);
+                --count_;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::size_t size() const noexcept { return count_; }
+    bool empty() const noexcept { return count_ == 0; }
+
+    void notify(const std::remove_reference_t<Args>&... args) {
+        struct Firing {
+            ListenerList& self;
+            explicit Firing(ListenerList& list) : self(list) { ++self.firing_; }
+            ~Firing() {
+                if (--self.firing_ == 0)
+                    self.compact();
+            }
+        } firing(*this);
+
+        const std::size_t n = entries_.size();
+        for (std::size_t i = 0; i < n; ++i) {
+            if (entries_[i].active)
+                entries_[i].listener(args...);
+        }
+    }
+
+private:
+    struct Entry {
+        ListenerId id;
+        Listener listener;
+        bool active = true;
+    };
+
+    void compact() {
+        std::erase_if(entries_, [](const Entry& e) { return !e.active; });
+        for (auto& entry : pending_)
+            entries_.push_back(std::move(entry));
+        pending_.clear();
+    }
+
+    std::vector<Entry> entries_;
+    std::vector<Entry> pending_;
+    std::size_t count_ = 0;
+    ListenerId last_id_ = 0;
+    unsigned firing_ = 0;
+};
+
+/// A `ListenerList` allocated on first subscription, so objects without
+/// listeners pay one pointer.  Listeners belong to the object they were
+/// registered on: copying or moving the owner does not carry them along.
+template <class... Args>
+class LazyListenerList {
+public:
+    using Listener = typename ListenerList<Args...>::Listener;
+
+    LazyListenerList() noexcept = default;
+    LazyListenerList(const LazyListenerList&) noexcept {}
+    LazyListenerList(LazyListenerList&&) noexcept {}
+    LazyListenerList& operator=(const LazyListenerList&) noexcept { return *this; }
+    LazyListenerList& operator=(LazyListenerList&&) noexcept { return *this; }
+
+    ListenerId subscribe(Listener listener) {
+        if (!list_)
+            list_ = std::make_unique<ListenerList<Args...>>();
+        return list_->subscribe(std::move(listener));
+    }
+
+    bool unsubscribe(ListenerId id) { return list_ && list_->unsubscribe(id); }
+
+    std::size_t size() const noexcept { return list_ ? list_->size() : 0; }
+    bool empty() const noexcept { return !list_ || list_->empty(); }
+
+    void notify(const std::remove_reference_t<Args>&... args) {
+        if (list_)
+            list_->notify(args...);
+    }
+
+private:
+    std::unique_ptr<ListenerList<Args...>> list_;
+};
+
+}  // namespace detail
+}  // namespace beans
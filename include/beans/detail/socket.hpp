@@ -0,0 +1,267 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace beans {
+
+/// Where a leader listens and followers connect: a Unix domain socket path
+/// or a TCP port on the loopback interface.
+struct Endpoint {
+    enum class Kind { Unix, Tcp };
+
+    Kind kind;
+    std::string path;
+    std::uint16_t port = 0;
+
+    static Endpoint unix_socket(std::string path) { return {Kind::Unix, std::move(path), 0}; }
+    static Endpoint tcp(std::uint16_t port) { return {Kind::Tcp, {}, port}; }
+};
+
+namespace detail {
+
+[[noreturn]] inline void throw_errno(const char* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+/// Owns a non-blocking socket descriptor.
+class Socket {
+public:
+    Socket() noexcept = default;
+    explicit Socket(int fd) noexcept : fd_(fd) {}
+    Socket(Socket&& other) noexcept : fd_(std::exchange(other.fd_, -1)) {}
+    Socket& operator=(Socket&& other) noexcept {
+        if (this != &other) {
+            close();
+            fd_ = std::exchange(other.fd_, -1);
+        }
+        return *this;
+    }
+    ~Socket() { close(); }
+
+    int fd() const noexcept { return fd_; }
+    explicit operator bool() const noexcept { return fd_ >= 0; }
+
+    void close() noexcept {
+        if (fd_ >= 0)
+            ::close(fd_);
+        fd_ = -1;
+    }
+
+    /// Creates a listening socket bound to `endpoint`, replacing a stale Unix
+    /// socket file.
+    static Socket listen(const Endpoint& endpoint) {
+        Socket s = open(endpoint);
+        if (endpoint.kind == Endpoint::Kind::Unix) {
+            ::unlink(endpoint.path.c_str());
+        } else {
+            const int one = 1;
+            ::setsockopt(s.fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+        }
+        Address a(endpoint);
+        if (::bind(s.fd_, a.get(), a.size) != 0)
+            throw_errno("bind");
+        if (::listen(s.fd_, 16) != 0)
+            throw_errno("listen");
+        return s;
+    }
+
+    /// Starts connecting to `endpoint`; the connection may still be in
+    /// progress when this returns.  Returns an empty socket if the peer is
+    /// not there yet.
+    static Socket connect(const Endpoint& endpoint) {
+        Socket s = open(endpoint);
+        Address a(endpoint);
+        if (::connect(s.fd_, a.get(), a.size) != 0 && errno != EINPROGRESS)
+            return {};
+        return s;
+    }
+
+    /// Accepts a pending connection, or returns an empty socket.
+    Socket accept() const {
+        const int fd = ::accept(fd_, nullptr, nullptr);
+        if (fd < 0)
+            return {};
+        Socket s(fd);
+        s.configure();
+        return s;
+    }
+
+private:
+    struct Address {
+        sockaddr_storage storage{};
+        socklen_t size = 0;
+
+        explicit Address(const Endpoint& endpoint) {
+            if (endpoint.kind == Endpoint::Kind::Unix) {
+                auto* un = reinterpret_cast<sockaddr_un*>(&storage);
+                un->sun_family = AF_UNIX;
+                if (endpoint.path.size() >= sizeof un->sun_path)
+                    throw std::system_error(ENAMETOOLONG, std::generic_category(), endpoint.path);
+                std::memcpy(un->sun_path, endpoint.path.c_str(), endpoint.path.size() + 1);
+                size = sizeof(sockaddr_un);
+            } else {
+                auto* in = reinterpret_cast<sockaddr_in*>(&storage);
+                in->sin_family = AF_INET;
+                in->sin_port = htons(endpoint.port);
+                in->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                size = sizeof(sockaddr_in);
+            }
+        }
+
+        const sockaddr* get() const noexcept { return reinterpret_cast<const sockaddr*>(&storage); }
+    };
+
+    static Socket open(const Endpoint& endpoint) {
+        const int domain = endpoint.kind == Endpoint::Kind::Unix ? AF_UNIX : AF_INET;
+        Socket s(::socket(domain, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+        if (!s)
+            throw_errno("socket");
+        if (endpoint.kind == Endpoint::Kind::Tcp) {
+            // Batches are already coalesced; do not delay them further.
+            const int one = 1;
+            ::setsockopt(s.fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+        }
+        return s;
+    }
+
+    void configure() noexcept {
+        ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) | O_NONBLOCK);
+        ::fcntl(fd_, F_SETFD, FD_CLOEXEC);
+        const int one = 1;
+        ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);  // Fails harmlessly on Unix sockets.
+    }
+
+    int fd_ = -1;
+};
+
+/// Buffered framing over a non-blocking stream socket.  Frames are a 32-bit
+/// little-endian length followed by that many bytes.
+class FramedConnection {
+public:
+    static constexpr std::size_t max_frame = 0xffffffff;
+
+    FramedConnection() = default;
+    explicit FramedConnection(Socket socket) : socket_(std::move(socket)) {}
+
+    Socket& socket() noexcept { return socket_; }
+    bool open() const noexcept { return static_cast<bool>(socket_); }
+    std::size_t pending_output() const noexcept { return out_.size() - sent_; }
+
+    /// Bytes written to the socket since the connection was opened.
+    std::uint64_t written() const noexcept { return written_; }
+
+    void close() noexcept {
+        socket_.close();
+        out_.clear();
+        in_.clear();
+        sent_ = 0;
+        written_ = 0;
+    }
+
+    /// Starts a frame in the output buffer; returns its offset for `end_frame`.
+    std::size_t begin_frame() {
+        const std::size_t at = out_.size();
+        out_.append(4, '\0');
+        return at;
+    }
+
+    std::string& output() noexcept { return out_; }
+
+    /// Closes the frame started at `at`.  A payload too long for the length
+    /// prefix is dropped and throws `std::length_error`.
+    void end_frame(std::size_t at) {
+        if (out_.size() - at - 4 > max_frame) {
+            out_.resize(at);
+            throw std::length_error("frame exceeds 4 GiB");
+        }
+        const auto n = static_cast<std::uint32_t>(out_.size() - at - 4);
+        for (int i = 0; i < 4; ++i)
+            out_[at + i] = static_cast<char>(n >> (8 * i));
+    }
+
+    /// Appends a complete frame.
+    void send(std::string_view payload) {
+        const std::size_t at = begin_frame();
+        out_.append(payload);
+        end_frame(at);
+    }
+
+    /// Writes as much buffered output as the socket takes; false if the
+    /// connection failed.
+    bool flush() {
+        while (sent_ < out_.size()) {
+            const ssize_t n = ::send(socket_.fd(), out_.data() + sent_, out_.size() - sent_, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOTCONN)
+                    break;
+                return false;
+            }
+            sent_ += static_cast<std::size_t>(n);
+            written_ += static_cast<std::uint64_t>(n);
+        }
+        if (sent_ == out_.size()) {
+            out_.clear();
+            sent_ = 0;
+        } else if (sent_ > (1u << 20)) {
+            out_.erase(0, sent_);
+            sent_ = 0;
+        }
+        return true;
+    }
+
+    /// Reads what is available; false if the peer closed or failed.
+    bool receive() {
+        char buf[64 * 1024];
+        for (;;) {
+            const ssize_t n = ::recv(socket_.fd(), buf, sizeof buf, 0);
+            if (n > 0) {
+                in_.append(buf, static_cast<std::size_t>(n));
+                continue;
+            }
+            if (n == 0)
+                return false;
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOTCONN;
+        }
+    }
+
+    /// Calls `f(payload)` for each complete frame received so far.
+    template <class F>
+    void for_each_frame(F&& f) {
+        std::size_t at = 0;
+        while (in_.size() - at >= 4) {
+            std::uint32_t n = 0;
+            for (int i = 0; i < 4; ++i)
+                n |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(in_[at + i])) << (8 * i);
+            if (in_.size() - at - 4 < n)
+                break;
+            f(std::string_view(in_).substr(at + 4, n));
+            at += 4 + n;
+        }
+        in_.erase(0, at);
+    }
+
+private:
+    Socket socket_;
+    std::string out_;
+    std::size_t sent_ = 0;
+    std::uint64_t written_ = 0;
+    std::string in_;
+};
+
+}  // namespace detail
+}  // namespace beans
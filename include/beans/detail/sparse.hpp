@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace beans::detail {
+
+/// One set sparse value: small trivially copyable values live in the entry,
+/// others on the heap behind a pointer stored in it.  Either way an entry is
+/// trivially relocatable, so the table grows with realloc.
+struct SparseEntry {
+    std::uint32_t key;
+    alignas(8) unsigned char bytes[8];
+};
+
+template <class T>
+inline constexpr bool sparse_inline_v = sizeof(T) <= sizeof(SparseEntry::bytes) &&
+                                        alignof(T) <= alignof(SparseEntry) && std::is_trivially_copyable_v<T>;
+
+/// Side table for the sparse fields of a bean, in the manner of WPF
+/// dependency properties: only values that differ from their default are
+/// stored, in a block of entries sorted by key that is allocated on first
+/// use.  An empty table costs one pointer.  Field `K` has type
+/// `std::tuple_element_t<K, std::tuple<Ts...>>` and defaults to a
+/// value-initialised `T`.
+template <class... Ts>
+class SparseStore {
+public:
+    static constexpr std::size_t count = sizeof...(Ts);
+
+    template <std::size_t K>
+    using type = std::tuple_element_t<K, std::tuple<Ts...>>;
+
+    SparseStore() noexcept = default;
+
+    SparseStore(const SparseStore& other) {
+        if (!other.size())
+            return;
+        block_ = allocate(other.size());
+        try {
+            for (const SparseEntry& e : other.entries()) {
+                SparseEntry& copy = block_->entries()[block_->size];
+                copy.key = e.key;
+                copiers[e.key](copy, e);
+                ++block_->size;
+            }
+        } catch (...) {
+            reset();
+            throw;
+        }
+    }
+
+    SparseStore(SparseStore&& other) noexcept : block_(std::exchange(other.block_, nullptr)) {}
+
+    SparseStore& operator=(const SparseStore& other) {
+        if (this != &other) {
+            SparseStore copy(other);
+            std::swap(block_, copy.block_);
+        }
+        return *this;
+    }
+
+    SparseStore& operator=(SparseStore&& other) noexcept {
+        if (this != &other) {
+            reset();
+            block_ = std::exchange(other.block_, nullptr);
+        }
+        return *this;
+    }
+
+    ~SparseStore() { reset(); }
+
+    /// Number of fields holding a non-default value.
+    std::size_t size() const noexcept { return block_ ? block_->size : 0; }
+
+    template <std::size_t K>
+    bool contains() const noexcept {
+        return find(K) != nullptr;
+    }
+
+    /// The value of field `K`, or its default if it is not stored.
+    template <std::size_t K>
+    const type<K>& get() const noexcept {
+        if (const SparseEntry* e = find(K))
+            return value<type<K>>(*e);
+        return default_value<type<K>>();
+    }
+
+    /// Mutable access; stores the default first if the field is not stored.
+    /// The reference is valid until another field of this table is set or
+    /// cleared.
+    template <std::size_t K>
+    type<K>& ref() {
+        if (SparseEntry* e = find(K))
+            return value<type<K>>(*e);
+        SparseEntry& e = insert(K);
+        try {
+            construct<type<K>>(e, type<K>{});
+        } catch (...) {
+            erase_slot(e);
+            throw;
+        }
+        return value<type<K>>(e);
+    }
+
+    /// Stores `v` in field `K`; storing the default value removes the entry,
+    /// so the table only ever holds non-default values.
+    template <std::size_t K, class V>
+    void set(V&& v) {
+        using T = type<K>;
+        SparseEntry* e = find(K);
+        if constexpr (std::equality_comparable<T>) {
+            if (v == default_value<T>()) {
+                if (e)
+                    erase<K>(*e);
+                return;
+            }
+        }
+        if (e) {
+            value<T>(*e) = std::forward<V>(v);
+            return;
+        }
+        T copy(std::forward<V>(v));  // Inserting may move the entry `v` refers to.
+        SparseEntry& slot = insert(K);
+        try {
+            construct<T>(slot, std::move(copy));
+        } catch (...) {
+            erase_slot(slot);
+            throw;
+        }
+    }
+
+    /// Restores field `K` to its default value.
+    template <std::size_t K>
+    void clear() noexcept {
+        if (SparseEntry* e = find(K))
+            erase<K>(*e);
+    }
+
+    /// Compares effective values, so a stored default equals an absent one.
+    friend constexpr bool operator==(const SparseStore& a, const SparseStore& b)
+        requires(std::equality_comparable<Ts> && ...)
+    {
+        const SparseEntry* x = a.entries().begin();
+        const SparseEntry* const x_end = a.entries().end();
+        const SparseEntry* y = b.entries().begin();
+        const SparseEntry* const y_end = b.entries().end();
+        while (x != x_end || y != y_end) {
+            if (y == y_end || (x != x_end && x->key < y->key)) {
+                if (!equals[x->key](x, nullptr))
+                    return false;
+                ++x;
+            } else if (x == x_end || y->key < x->key) {
+                if (!equals[y->key](y, nullptr))
+                    return false;
+                ++y;
+            } else {
+                if (!equals[x->key](x, y))
+                    return false;
+                ++x;
+                ++y;
+            }
+        }
+        return true;
+    }
+
+private:
+    struct Block {
+        std::uint32_t size;
+        std::uint32_t capacity;
+
+        SparseEntry* entries() noexcept { return reinterpret_cast<SparseEntry*>(this + 1); }
+    };
+    static_assert(sizeof(Block) % alignof(SparseEntry) == 0);
+
+    struct Range {
+        SparseEntry* first;
+        SparseEntry* last;
+        SparseEntry* begin() const noexcept { return first; }
+        SparseEntry* end() const noexcept { return last; }
+    };
+
+    Range entries() const noexcept {
+        if (!block_)
+            return {nullptr, nullptr};
+        return {block_->entries(), block_->entries() + block_->size};
+    }
+
+    template <class T>
+    static const T& default_value() noexcept {
+        static const T value{};
+        return value;
+    }
+
+    template <class T>
+    static T& value(const SparseEntry& e) noexcept {
+        auto& bytes = const_cast<SparseEntry&>(e).bytes;
+        if constexpr (sparse_inline_v<T>) {
+            return *std::launder(reinterpret_cast<T*>(bytes));
+        } else {
+            T* p;
+            std::memcpy(&p, bytes, sizeof p);
+            return *p;
+        }
+    }
+
+    template <class T, class V>
+    static void construct(SparseEntry& e, V&& v) {
+        if constexpr (sparse_inline_v<T>) {
+            ::new (static_cast<void*>(e.bytes)) T(std::forward<V>(v));
+        } else {
+            T* p = new T(std::forward<V>(v));
+            std::memcpy(e.bytes, &p, sizeof p);
+        }
+    }
+
+    template <class T>
+    static void destroy(SparseEntry& e) noexcept {
+        if constexpr (!sparse_inline_v<T>)
+            delete &value<T>(e);
+    }
+
+    template <class T>
+    static void copy(SparseEntry& to, const SparseEntry& from) {
+        construct<T>(to, value<T>(from));
+    }
+
+    template <class T>
+    static bool equal(const SparseEntry* a, const SparseEntry* b) {
+        if constexpr (std::equality_comparable<T>)
+            return value<T>(*a) == (b ? value<T>(*b) : default_value<T>());
+        else
+            return false;
+    }
+
+    using Destroy = void (*)(SparseEntry&) noexcept;
+    using Copy = void (*)(SparseEntry&, const SparseEntry&);
+    using Equal = bool (*)(const SparseEntry*, const SparseEntry*);
+
+    static constexpr Destroy destroyers[] = {&destroy<Ts>...};
+    static constexpr Copy copiers[] = {&copy<Ts>...};
+    static constexpr Equal equals[] = {&equal<Ts>...};
+
+    const SparseEntry* find(std::uint32_t key) const noexcept {
+        const Range r = entries();
+        const SparseEntry* e =
+            std::lower_bound(r.begin(), r.end(), key, [](const SparseEntry& x, std::uint32_t k) { return x.key < k; });
+        return e != r.end() && e->key == key ? e : nullptr;
+    }
+    SparseEntry* find(std::uint32_t key) noexcept {
+        return const_cast<SparseEntry*>(std::as_const(*this).find(key));
+    }
+
+    static Block* allocate(std::size_t capacity) {
+        auto* block = static_cast<Block*>(std::malloc(sizeof(Block) + capacity * sizeof(SparseEntry)));
+        if (!block)
+            throw std::bad_alloc();
+        block->size = 0;
+        block->capacity = static_cast<std::uint32_t>(capacity);
+        return block;
+    }
+
+    /// Opens a slot for `key` in sorted position; the value is not built.
+    SparseEntry& insert(std::uint32_t key) {
+        if (!block_) {
+            block_ = allocate(4);
+        } else if (block_->size == block_->capacity) {
+            const std::size_t capacity = std::min<std::size_t>(2 * block_->capacity, count);
+            auto* grown = static_cast<Block*>(std::realloc(block_, sizeof(Block) + capacity * sizeof(SparseEntry)));
+            if (!grown)
+                throw std::bad_alloc();
+            block_ = grown;
+            block_->capacity = static_cast<std::uint32_t>(capacity);
+        }
+        SparseEntry* first = block_->entries();
+        SparseEntry* pos = std::lower_bound(first, first + block_->size, key,
+                                            [](const SparseEntry& x, std::uint32_t k) { return x.key < k; });
+        std::memmove(pos + 1, pos, static_cast<std::size_t>(first + block_->size - pos) * sizeof(SparseEntry));
+        ++block_->size;
+        pos->key = key;
+        return *pos;
+    }
+
+    /// Closes the slot `e`, whose value is already destroyed or never built.
+    void erase_slot(SparseEntry& e) noexcept {
+        SparseEntry* end = block_->entries() + block_->size;
+        std::memmove(&e, &e + 1, static_cast<std::size_t>(end - (&e + 1)) * sizeof(SparseEntry));
+        if (--block_->size == 0) {
+            std::free(block_);
+            block_ = nullptr;
+        }
+    }
+
+    template <std::size_t K>
+    void erase(SparseEntry& e) noexcept {
+        destroy<type<K>>(e);
+        erase_slot(e);
+    }
+
+    void reset() noexcept {
+        if (!block_)
+            return;
+        for (SparseEntry& e : entries())
+            destroyers[e.key](e);
+        std::free(block_);
+        block_ = nullptr;
+    }
+
+    Block* block_ = nullptr;
+};
+
+/// No sparse fields: no storage.
+template <>
+class SparseStore<> {
+public:
+    static constexpr std::size_t count = 0;
+    std::size_t size() const noexcept { return 0; }
+    friend constexpr bool operator==(const SparseStore&, const SparseStore&) noexcept = default;
+};
+
+}  // namespace beans::detail
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "../relocate.hpp"
+#include "kernels.hpp"
+
+namespace beans::detail {
+
+/// Minimal contiguous vector used by the library's containers.  Unlike
+/// `std::vector` it relocates trivially relocatable elements with
+/// realloc/memmove when growing, inserting and erasing, so elements that own
+/// heap memory are not moved and destroyed one by one.
+template <class T>
+class Vector {
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    Vector() noexcept = default;
+
+    Vector(std::initializer_list<T> values) {
+        reserve(values.size());
+        for (const T& v : values)
+            emplace_back(v);
+    }
+
+    Vector(const Vector& other) {
+        reserve(other.size_);
+        std::uninitialized_copy(other.begin(), other.end(), data_);
+        size_ = other.size_;
+    }
+
+    Vector(Vector&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)),
+          capacity_(std::exchange(other.capacity_, 0)) {}
+
+    Vector& operator=(const Vector& other) {
+        if (this != &other) {
+            Vector copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    Vector& operator=(Vector&& other) noexcept {
+        if (this != &other) {
+            Vector moved(std::move(other));
+            swap(moved);
+        }
+        return *this;
+    }
+
+    ~Vector() {
+        std::destroy(begin(), end());
+        deallocate(data_);
+    }
+
+    void swap(Vector& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    T* data() noexcept { return data_; }
+    const T* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+    std::size_t capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    T* begin() noexcept { return data_; }
+    T* end() noexcept { return data_ + size_; }
+    const T* begin() const noexcept { return data_; }
+    const T* end() const noexcept { return data_ + size_; }
+
+    T& operator[](std::size_t i) noexcept { return data_[i]; }
+    const T& operator[](std::size_t i) const noexcept { return data_[i]; }
+    T& back() noexcept { return data_[size_ - 1]; }
+
+    void reserve(std::size_t n) {
+        if (n > capacity_)
+            reallocate(n);
+    }
+
+    template <class... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == capacity_) {
+            // `args` may refer to an element of this vector; build the new
+            // element before the storage moves.
+            T value(std::forward<Args>(args)...);
+            reallocate(grown());
+            ::new (static_cast<void*>(data_ + size_)) T(std::move(value));
+        } else {
+            ::new (static_cast<void*>(data_ + size_)) T(std::forward<Args>(args)...);
+        }
+        return data_[size_++];
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void pop_back() noexcept {
+        --size_;
+        std::destroy_at(data_ + size_);
+    }
+
+    /// Inserts `value` before index `pos` and returns a reference to it.
+    template <class... Args>
+    T& emplace(std::size_t pos, Args&&... args) {
+        if (pos == size_)
+            return emplace_back(std::forward<Args>(args)...);
+        T value(std::forward<Args>(args)...);
+        if (size_ == capacity_)
+            reallocate(grown());
+        if constexpr (is_trivially_relocatable_v<T>) {
+            std::memmove(static_cast<void*>(data_ + pos + 1), static_cast<const void*>(data_ + pos),
+                         (size_ - pos) * sizeof(T));
+            ::new (static_cast<void*>(data_ + pos)) T(std::move(value));
+        } else {
+            ::new (static_cast<void*>(data_ + size_)) T(std::move(data_[size_ - 1]));
+            std::move_backward(data_ + pos, data_ + size_ - 1, data_ + size_);
+            data_[pos] = std::move(value);
+        }
+        ++size_;
+        return data_[pos];
+    }
+
+    /// Removes elements `[first, last)`, keeping the order of the rest.
+    void erase(std::size_t first, std::size_t last) noexcept(is_trivially_relocatable_v<T> ||
+                                                             std::is_nothrow_move_assignable_v<T>) {
+        if (first >= last)
+            return;
+        if constexpr (is_trivially_relocatable_v<T>) {
+            std::destroy(data_ + first, data_ + last);
+            std::memmove(static_cast<void*>(data_ + first), static_cast<const void*>(data_ + last),
+                         (size_ - last) * sizeof(T));
+        } else {
+            std::move(data_ + last, data_ + size_, data_ + first);
+            std::destroy(data_ + size_ - (last - first), data_ + size_);
+        }
+        size_ -= last - first;
+    }
+
+    void erase(std::size_t pos) { erase(pos, pos + 1); }
+
+    void clear() noexcept {
+        std::destroy(begin(), end());
+        size_ = 0;
+    }
+
+    /// Grows with value-initialised elements or shrinks to `n` elements.
+    void resize(std::size_t n) {
+        if (n < size_) {
+            std::destroy(data_ + n, data_ + size_);
+        } else if (n > size_) {
+            reserve(n);
+            std::uninitialized_value_construct(data_ + size_, data_ + n);
+        }
+        size_ = n;
+    }
+
+    /// Grows with copies of `value` or shrinks to `n` elements.  `value` may
+    /// be an element of this vector.
+    void resize(std::size_t n, const T& value) {
+        if (n <= size_) {
+            std::destroy(data_ + n, data_ + size_);
+            size_ = n;
+            return;
+        }
+        const T fill = value;  // Growing may move the element `value` refers to.
+        reserve(n);
+        if constexpr (simd_kernel_v<T>)
+            fill_n(data_ + size_, n - size_, fill);
+        else
+            std::uninitialized_fill(data_ + size_, data_ + n, fill);
+        size_ = n;
+    }
+
+private:
+    // realloc() only guarantees fundamental alignment.
+    static constexpr bool use_realloc =
+        is_trivially_relocatable_v<T> && alignof(T) <= alignof(std::max_align_t);
+
+    std::size_t grown() const noexcept { return capacity_ ? 2 * capacity_ : 4; }
+
+    void reallocate(std::size_t n) {
+        if constexpr (use_realloc) {
+            // realloc may extend in place; otherwise it memcpy's, which is a
+            // valid relocation for these types.
+            void* p = std::realloc(static_cast<void*>(data_), n * sizeof(T));
+            if (!p)
+                throw std::bad_alloc();
+            data_ = static_cast<T*>(p);
+        } else {
+            T* fresh = allocate(n);
+            try {
+                relocate(data_, data_ + size_, fresh);
+            } catch (...) {
+                deallocate(fresh);
+                throw;
+            }
+            deallocate(data_);
+            data_ = fresh;
+        }
+        capacity_ = n;
+    }
+
+    static T* allocate(std::size_t n) {
+        if constexpr (use_realloc) {
+            void* p = std::malloc(n * sizeof(T));
+            if (!p)
+                throw std::bad_alloc();
+            return static_cast<T*>(p);
+        } else {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+        }
+    }
+
+    static void deallocate(T* p) noexcept {
+        if constexpr (use_realloc)
+            std::free(static_cast<void*>(p));
+        else if (p)
+            ::operator delete(static_cast<void*>(p), std::align_val_t(alignof(T)));
+    }
+
+    T* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+};
+
+}  // namespace beans::detail
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace beans::detail {
+
+/// Appends `v` as a base-128 varint (7 bits per byte, low bits first).
+inline void put_varint(std::string& out, std::uint64_t v) {
+    char buf[10];
+    std::size_t n = 0;
+    while (v >= 0x80) {
+        buf[n++] = static_cast<char>(static_cast<std::uint8_t>(v) | 0x80);
+        v >>= 7;
+    }
+    buf[n++] = static_cast<char>(v);
+    out.append(buf, n);
+}
+
+/// Writes `v` as a varint at `p`, which must have room for ten bytes, and
+/// returns the end of what was written.
+inline char* write_varint(char* p, std::uint64_t v) noexcept {
+    if (v < 0x80) {
+        *p = static_cast<char>(v);
+        return p + 1;
+    }
+    if (v < 0x4000) {
+        p[0] = static_cast<char>(static_cast<std::uint8_t>(v) | 0x80);
+        p[1] = static_cast<char>(v >> 7);
+        return p + 2;
+    }
+    while (v >= 0x80) {
+        *p++ = static_cast<char>(static_cast<std::uint8_t>(v) | 0x80);
+        v >>= 7;
+    }
+    *p++ = static_cast<char>(v);
+    return p;
+}
+
+inline std::size_t varint_size(std::uint64_t v) noexcept {
+    std::size_t n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        ++n;
+    }
+    return n;
+}
+
+/// Reads a varint from the front of `in`; returns false if it is truncated or
+/// longer than ten bytes.
+inline bool get_varint(std::string_view& in, std::uint64_t& v) noexcept {
+    // Fast paths: one- and two-byte values are the common case for tags,
+    // lengths and small numbers.
+    if (!in.empty() && static_cast<std::uint8_t>(in[0]) < 0x80) {
+        v = static_cast<std::uint8_t>(in[0]);
+        in.remove_prefix(1);
+        return true;
+    }
+    if (in.size() >= 2 && static_cast<std::uint8_t>(in[1]) < 0x80) {
+        v = (static_cast<std::uint8_t>(in[0]) & 0x7fu) | (std::uint64_t{static_cast<std::uint8_t>(in[1])} << 7);
+        in.remove_prefix(2);
+        return true;
+    }
+    std::uint64_t result = 0;
+    for (std::size_t i = 0; i < in.size() && i < 10; ++i) {
+        const auto byte = static_cast<std::uint8_t>(in[i]);
+        result |= static_cast<std::uint64_t>(byte & 0x7f) << (7 * i);
+        if (byte < 0x80) {
+            v = result;
+            in.remove_prefix(i + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Appends the object representation of `v` (host byte order).
+template <class T>
+    requires std::is_trivially_copyable_v<T>
+inline void put_fixed(std::string& out, const T& v) {
+    char buf[sizeof(T)];
+    std::memcpy(buf, &v, sizeof(T));
+    out.append(buf, sizeof(T));
+}
+
+template <class T>
+    requires std::is_trivially_copyable_v<T>
+inline bool get_fixed(std::string_view& in, T& v) noexcept {
+    if (in.size() < sizeof(T))
+        return false;
+    std::memcpy(&v, in.data(), sizeof(T));
+    in.remove_prefix(sizeof(T));
+    return true;
+}
+
+/// Appends a varint length followed by the bytes of `s`.
+inline void put_bytes(std::string& out, std::string_view s) {
+    put_varint(out, s.size());
+    out.append(s);
+}
+
+inline bool get_bytes(std::string_view& in, std::string& s) {
+    std::uint64_t n = 0;
+    if (!get_varint(in, n) || n > in.size())
+        return false;
+    s.assign(in.data(), static_cast<std::size_t>(n));
+    in.remove_prefix(static_cast<std::size_t>(n));
+    return true;
+}
+
+}  // namespace beans::detail
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+
+namespace beans {
+
+/// String literal usable as a template argument, e.g. `Field<"price", double>`.
+template <std::size_t N>
+struct FixedString {
+    char data[N]{};
+
+    constexpr FixedString(const char (&literal)[N]) noexcept { std::copy_n(literal, N, data); }
+
+    static constexpr std::size_t size() noexcept { return N - 1; }
+    constexpr std::string_view view() const noexcept { return {data, N - 1}; }
+    constexpr operator std::string_view() const noexcept { return view(); }
+};
+
+}  // namespace beans
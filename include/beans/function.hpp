@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace beans {
+
+#ifdef BEANS_FUNCTION_CAPACITY
+inline constexpr std::size_t default_function_capacity = BEANS_FUNCTION_CAPACITY;
+#else
+/// Inline capacity used for listener storage unless configured otherwise.
+/// Callables up to this size (four pointers by default) never allocate.
+inline constexpr std::size_t default_function_capacity = 4 * sizeof(void*);
+#endif
+
+template <class Signature, std::size_t Capacity = default_function_capacity>
+class Function;
+
+/// Move-only replacement for `std::function` with a configurable inline
+/// buffer.  Callables that fit in `Capacity` bytes and are nothrow movable are
+/// stored inline; larger ones are heap allocated.  No RTTI is used: there is
+/// no `target()` or `target_type()`.
+///
+/// Like `std::function`, `operator()` is const but may call a mutable target.
+template <class R, class... Args, std::size_t Capacity>
+class Function<R(Args...), Capacity> {
+public:
+    static constexpr std::size_t capacity = Capacity;
+
+    Function() noexcept = default;
+    Function(std::nullptr_t) noexcept {}
+
+    template <class F>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, Function> &&
+                 std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+    Function(F&& f) {
+        using Target = std::decay_t<F>;
+        if constexpr (std::is_pointer_v<Target> || std::is_member_pointer_v<Target>) {
+            if (f == nullptr)
+                return;
+        }
+        if constexpr (stored_inline<Target>) {
+            ::new (static_cast<void*>(storage_)) Target(std::forward<F>(f));
+            invoke_ = &invoke_inline<Target>;
+            if constexpr (!(std::is_trivially_copyable_v<Target> &&
+                            std::is_trivially_destructible_v<Target>))
+                manage_ = &manage_inline<Target>;
+        } else {
+            *reinterpret_cast<Target**>(storage_) = new Target(std::forward<F>(f));
+            invoke_ = &invoke_heap<Target>;
+            manage_ = &manage_heap<Target>;
+        }
+    }
+
+    Function(Function&& other) noexcept { take(other); }
+
+    Function& operator=(Function&& other) noexcept {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    Function& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    template <class F>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, Function> &&
+                 std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+    Function& operator=(F&& f) {
+        return *this = Function(std::forward<F>(f));
+    }
+
+    Function(const Function&) = delete;
+    Function& operator=(const Function&) = delete;
+
+    ~Function() { reset(); }
+
+    explicit operator bool() const noexcept { return invoke_ != nullptr; }
+
+    R operator()(Args... args) const {
+        if (!invoke_)
+            throw std::bad_function_call();
+        return invoke_(storage_, std::forward<Args>(args)...);
+    }
+
+    void swap(Function& other) noexcept {
+        Function tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    friend bool operator==(const Function& f, std::nullptr_t) noexcept { return !f; }
+
+    /// True when a callable of type `F` would be stored without allocating.
+    template <class F>
+    static constexpr bool stored_inline =
+        sizeof(F) <= Capacity && alignof(F) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible_v<F>;
+
+private:
+    static_assert(Capacity >= sizeof(void*), "capacity must hold at least a pointer");
+
+    /// Moves the callable from `src` into `dst` and destroys it in `src`, or
+    /// destroys the callable in `dst` when `src` is null.
+    using Manage = void (*)(void* dst, void* src) noexcept;
+    using Invoke = R (*)(void* storage, Args&&... args);
+
+    template <class F>
+    static R invoke_inline(void* storage, Args&&... args) {
+        return std::invoke(*std::launder(static_cast<F*>(storage)), std::forward<Args>(args)...);
+    }
+
+    template <class F>
+    static R invoke_heap(void* storage, Args&&... args) {
+        return std::invoke(**static_cast<F**>(storage), std::forward<Args>(args)...);
+    }
+
+    template <class F>
+    static void manage_inline(void* dst, void* src) noexcept {
+        if (src) {
+            F* from = std::launder(static_cast<F*>(src));
+            ::new (dst) F(std::move(*from));
+            from->~F();
+        } else {
+            std::launder(static_cast<F*>(dst))->~F();
+        }
+    }
+
+    template <class F>
+    static void manage_heap(void* dst, void* src) noexcept {
+        if (src)
+            *static_cast<F**>(dst) = *static_cast<F**>(src);
+        else
+            delete *static_cast<F**>(dst);
+    }
+
+    void take(Function& other) noexcept {
+        if (!other.invoke_)
+            return;
+        if (other.manage_)
+            other.manage_(storage_, other.storage_);
+        else
+            std::memcpy(storage_, other.storage_, Capacity);
+        invoke_ = std::exchange(other.invoke_, nullptr);
+        manage_ = std::exchange(other.manage_, nullptr);
+    }
+
+    void reset() noexcept {
+        if (manage_)
+            manage_(storage_, nullptr);
+        invoke_ = nullptr;
+        manage_ = nullptr;
+    }
+
+    alignas(std::max_align_t) mutable std::byte storage_[Capacity];
+    Invoke invoke_ = nullptr;
+    // Null for trivially copyable inline callables, which are moved by memcpy.
+    Manage manage_ = nullptr;
+};
+
+}  // namespace beans
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <utility>
+
+#include "detail/kernels.hpp"
+#include "detail/listeners.hpp"
+#include "detail/vector.hpp"
+#include "function.hpp"
+#include "list_change.hpp"
+#include "sampling.hpp"
+
+namespace beans {
+
+/// An observable array of values, in the spirit of JavaBeans indexed
+/// properties.
+///
+/// Elements are read by index and written either one at a time with `set()`
+/// or in bulk with `fill()`, `assign()` and `transform()`.  Each write fires
+/// one `ListChange`: a bulk write over `[first, last)` fires a single
+/// `Replaced` event for the whole range, however many elements it touches,
+/// and `resize()` fires `Inserted` or `Removed`.  Bulk writes on arithmetic
+/// elements run vectorised kernels.  `set()` skips unchanged values, as
+/// `Property::set()` does; bulk writes do not compare.
+///
+/// Ranges must lie within the current size.  Not thread-safe.
+template <class T>
+class IndexedProperty {
+public:
+    using value_type = T;
+    using Listener = Function<void(const IndexedProperty&, const ListChange&)>;
+
+    IndexedProperty() = default;
+    explicit IndexedProperty(std::size_t size, const T& value = T{}) { init(size, value); }
+
+    /// Names the property for diagnostics such as slow-setter sampling.  Both
+    /// strings must outlive the property; string literals are the usual choice.
+    IndexedProperty(std::string_view bean_type, std::string_view name, std::size_t size = 0,
+                    const T& value = T{})
+        : bean_type_(bean_type), name_(name) {
+        init(size, value);
+    }
+
+    IndexedProperty(const IndexedProperty&) = delete;
+    IndexedProperty& operator=(const IndexedProperty&) = delete;
+
+    std::size_t size() const noexcept { return items_.size(); }
+    bool empty() const noexcept { return items_.empty(); }
+    const T& get(std::size_t i) const noexcept { return items_[i]; }
+    const T& operator[](std::size_t i) const noexcept { return items_[i]; }
+    const T* begin() const noexcept { return items_.begin(); }
+    const T* end() const noexcept { return items_.end(); }
+    std::span<const T> span() const noexcept { return {items_.data(), items_.size()}; }
+
+    void set(std::size_t i, T value) {
+        if constexpr (std::equality_comparable<T>) {
+            if (items_[i] == value)
+                return;
+        }
+        sampling::ScopedSetter timer(bean_type_, name_, listeners_.size());
+        items_[i] = std::move(value);
+        changed(ListChange::Kind::Replaced, i, i + 1);
+    }
+
+    /// Sets every element of `[first, last)` to `value`.
+    void fill(std::size_t first, std::size_t last, const T& value) {
+        if (first >= last)
+            return;
+        sampling::ScopedSetter timer(bean_type_, name_, listeners_.size());
+        detail::fill_n(items_.data() + first, last - first, value);
+        changed(ListChange::Kind::Replaced, first, last);
+    }
+    void fill(const T& value) { fill(0, size(), value); }
+
+    /// Overwrites the elements from `first` on with `values`.
+    void assign(std::size_t first, std::span<const T> values) {
+        if (values.empty())
+            return;
+        sampling::ScopedSetter timer(bean_type_, name_, listeners_.size());
+        detail::copy_n(items_.data() + first, values.data(), values.size());
+        changed(ListChange::Kind::Replaced, first, first + values.size());
+    }
+
+    /// Replaces each element `x` of `[first, last)` with `f(x)`.  For
+    /// arithmetic elements `f` should be a simple inlinable expression so the
+    /// kernel vectorises.
+    template <class F>
+    void transform(std::size_t first, std::size_t last, F f) {
+        if (first >= last)
+            return;
+        sampling::ScopedSetter timer(bean_type_, name_, listeners_.size());
+        detail::transform_n(items_.data() + first, last - first, f);
+        changed(ListChange::Kind::Replaced, first, last);
+    }
+    template <class F>
+    void transform(F f) {
+        transform(0, size(), std::move(f));
+    }
+
+    /// Grows to `size` elements equal to `value`, or shrinks to `size`.
+    void resize(std::size_t size, const T& value = T{}) {
+        const std::size_t old = items_.size();
+        if (size == old)
+            return;
+        sampling::ScopedSetter timer(bean_type_, name_, listeners_.size());
+        items_.resize(size, value);
+        if (size > old) {
+            changed(ListChange::Kind::Inserted, old, size);
+        } else {
+            changed(ListChange::Kind::Removed, size, old);
+        }
+    }
+
+    ListenerId subscribe(Listener listener) { return listeners_.subscribe(std::move(listener)); }
+
+    /// Removes the listener registered under `id`; returns false if unknown.
+    bool unsubscribe(ListenerId id) { return listeners_.unsubscribe(id); }
+
+    std::size_t listener_count() const noexcept { return listeners_.size(); }
+
+    std::string_view bean_type() const noexcept { return bean_type_; }
+    std::string_view name() const noexcept { return name_; }
+
+private:
+    void init(std::size_t size, const T& value) {
+        items_.resize(size);
+        detail::fill_n(items_.data(), size, value);
+    }
+
+    void changed(ListChange::Kind kind, std::size_t from, std::size_t to) {
+        if (!listeners_.empty())
+            listeners_.notify(*this, ListChange{kind, from, to});
+    }
+
+    detail::Vector<T> items_;
+    std::string_view bean_type_;
+    std::string_view name_;
+    detail::ListenerList<const IndexedProperty&, const ListChange&> listeners_;
+};
+
+}  // namespace beans
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "bean_tree.hpp"
+#include "detail/listeners.hpp"
+#include "detail/vector.hpp"
+#include "function.hpp"
+
+namespace beans {
+
+/// A property that flows down a `BeanTree`, like WPF inherited properties:
+/// each node either overrides the value or takes its parent's, and roots
+/// that do not override take the property's root value.
+///
+/// Effective values are cached per node, so `get()` is an array load.  A
+/// change at a node walks only the part of its subtree whose value actually
+/// changes: the walk stops at descendants that override the value, and at
+/// descendants that already held the new value.  Listeners hear
+/// `(node, old_value, new_value)` for each node whose effective value
+/// changes.  The property follows the tree's structure (nodes added, moved,
+/// removed) through a tree listener, and must not outlive the tree.
+/// Listeners must not change the property from inside a notification.
+template <class V, class T>
+class InheritedProperty {
+public:
+    using value_type = V;
+    using Listener = Function<void(NodeId node, const V& old_value, const V& new_value)>;
+
+    explicit InheritedProperty(BeanTree<T>& tree, V root_value = V{})
+        : tree_(tree), root_value_(std::move(root_value)) {
+        values_.resize(tree.capacity());
+        overrides_.resize(words(tree.capacity()));
+        for (std::size_t n = 0; n < tree.capacity(); ++n) {
+            if (tree.contains(static_cast<NodeId>(n)) && tree.parent(static_cast<NodeId>(n)) == no_node) {
+                values_[n] = root_value_;
+                propagate(static_cast<NodeId>(n));
+            }
+        }
+        structure_ = tree.subscribe([this](const BeanTree<T>&, const TreeChange& change) { on_change(change); });
+    }
+
+    InheritedProperty(const InheritedProperty&) = delete;
+    InheritedProperty& operator=(const InheritedProperty&) = delete;
+
+    ~InheritedProperty() { tree_.unsubscribe(structure_); }
+
+    /// Effective value at `node`.
+    const V& get(NodeId node) const noexcept { return values_[node]; }
+
+    /// Whether `node` sets its own value rather than inheriting one.
+    bool overrides(NodeId node) const noexcept { return (overrides_[node / 64] >> (node % 64)) & 1u; }
+
+    /// Makes `node` override the value with `value`.
+    void set(NodeId node, V value) {
+        overrides_[node / 64] |= std::uint64_t{1} << (node % 64);
+        assign(node, std::move(value));
+    }
+
+    /// Makes `node` inherit again.
+    void clear(NodeId node) {
+        if (!overrides(node))
+            return;
+        overrides_[node / 64] &= ~(std::uint64_t{1} << (node % 64));
+        assign(node, inherited(node));
+    }
+
+    const V& root_value() const noexcept { return root_value_; }
+
+    /// Changes the value taken by roots that do not override it.
+    void set_root_value(V value) {
+        root_value_ = std::move(value);
+        for (std::size_t n = 0; n < values_.size(); ++n) {
+            const auto node = static_cast<NodeId>(n);
+            if (tree_.contains(node) && tree_.parent(node) == no_node && !overrides(node))
+                assign(node, root_value_);
+        }
+    }
+
+    ListenerId subscribe(Listener listener) { return listeners_.subscribe(std::move(listener)); }
+
+    /// Removes the listener registered under `id`; returns false if unknown.
+    bool unsubscribe(ListenerId id) { return listeners_.unsubscribe(id); }
+
+private:
+    static std::size_t words(std::size_t nodes) noexcept { return (nodes + 63) / 64; }
+
+    const V& inherited(NodeId node) const noexcept {
+        const NodeId parent = tree_.parent(node);
+        return parent == no_node ? root_value_ : values_[parent];
+    }
+
+    /// Sets the effective value at `node` and carries it down.
+    void assign(NodeId node, V value) {
+        if constexpr (std::equality_comparable<V>) {
+            if (values_[node] == value)
+                return;
+        }
+        V old = std::exchange(values_[node], std::move(value));
+        if (!listeners_.empty())
+            listeners_.notify(node, old, values_[node]);
+        propagate(node);
+    }
+
+    /// Pushes the value at `from` to the descendants that inherit it and do
+    /// not already hold it.  Iterative, as trees can be deep.
+    void propagate(NodeId from) {
+        stack_.clear();
+        tree_.for_each_child(from, [&](NodeId c) { stack_.emplace_back(c); });
+        while (!stack_.empty()) {
+            const NodeId node = stack_.back();
+            stack_.pop_back();
+            if (overrides(node))
+                continue;
+            const V& value = values_[tree_.parent(node)];
+            if constexpr (std::equality_comparable<V>) {
+                if (values_[node] == value)
+                    continue;
+            }
+            V old = std::exchange(values_[node], value);
+            if (!listeners_.empty())
+                listeners_.notify(node, old, values_[node]);
+            tree_.for_each_child(node, [&](NodeId c) { stack_.emplace_back(c); });
+        }
+    }
+
+    void on_change(const TreeChange& change) {
+        const NodeId node = change.node;
+        switch (change.kind) {
+        case TreeChange::Kind::Added:
+            // New ids are handed out in order; emplace_back grows geometrically.
+            while (values_.size() <= node)
+                values_.emplace_back();
+            while (overrides_.size() < words(node + 1))
+                overrides_.emplace_back();
+            overrides_[node / 64] &= ~(std::uint64_t{1} << (node % 64));
+            values_[node] = inherited(node);
+            break;
+        case TreeChange::Kind::Moved:
+            if (!overrides(node))
+                assign(node, inherited(node));
+            break;
+        case TreeChange::Kind::Removed:
+            // Slots are reinitialised when their ids are reused.
+            break;
+        }
+    }
+
+    BeanTree<T>& tree_;
+    V root_value_;
+    detail::Vector<V> values_;
+    detail::Vector<std::uint64_t> overrides_;
+    detail::Vector<NodeId> stack_;
+    ListenerId structure_ = 0;
+    detail::ListenerList<NodeId, const V&, const V&> listeners_;
+};
+
+}  // namespace beans
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+#include "detail/listeners.hpp"
+#include "function.hpp"
+#include "sampling.hpp"
+
+namespace beans {
+
+/// Sources of a `LayeredProperty` value, lowest precedence first.
+enum class Layer : std::uint8_t { Default, Inherited, Style, Local, Animation };
+
+inline constexpr std::size_t layer_count = 5;
+
+/// A property whose value comes from layered sources, in the spirit of WPF
+/// dependency properties: the effective value is the one from the highest set
+/// layer, `Layer::Default` always being set.
+///
+/// The layer the effective value comes from is cached, so `get()` is one
+/// indexed load rather than a precedence walk.  Writing a layer only does
+/// work beyond the store when the layer is at or above the effective one.
+/// Listeners hear `(old_value, new_value)` when the effective value changes,
+/// and only then: setting a layer that is shadowed by a higher one is silent.
+///
+/// Not thread-safe; synchronise externally if shared.
+template <class T>
+class LayeredProperty {
+public:
+    using value_type = T;
+    using Listener = Function<void(const T& old_value, const T& new_value)>;
+
+    LayeredProperty() = default;
+    explicit LayeredProperty(T default_value) { values_[0] = std::move(default_value); }
+
+    /// Names the property for diagnostics such as slow-setter sampling.  Both
+    /// strings must outlive the property; string literals are the usual choice.
+    LayeredProperty(std::string_view bean_type, std::string_view name, T default_value = T{})
+        : bean_type_(bean_type), name_(name) {
+        values_[0] = std::move(default_value);
+    }
+
+    LayeredProperty(const LayeredProperty&) = delete;
+    LayeredProperty& operator=(const LayeredProperty&) = delete;
+
+    /// The effective value.
+    const T& get() const noexcept { return values_[top_]; }
+    operator const T&() const noexcept { return get(); }
+
+    /// The layer the effective value comes from.
+    Layer source() const noexcept { return static_cast<Layer>(top_); }
+
+    bool has(Layer layer) const noexcept { return (set_ >> index(layer)) & 1u; }
+
+    /// The value stored in `layer`; meaningless unless `has(layer)`.
+    const T& get(Layer layer) const noexcept { return values_[index(layer)]; }
+
+    /// Stores `value` in `layer`.
+    void set(Layer layer, T value) {
+        const std::uint8_t i = index(layer);
+        if (i < top_) {
+            // Shadowed: the effective value cannot change.
+            values_[i] = std::move(value);
+            set_ |= static_cast<std::uint8_t>(1u << i);
+            return;
+        }
+        if (i == top_) {
+            if constexpr (std::equality_comparable<T>) {
+                if (values_[i] == value)
+                    return;
+            }
+            sampling::ScopedSetter timer(bean_type_, name_, listeners_.size());
+            T old = std::exchange(values_[i], std::move(value));
+            listeners_.notify(old, values_[i]);
+            return;
+        }
+        values_[i] = std::move(value);
+        set_ |= static_cast<std::uint8_t>(1u << i);
+        raise(i);
+    }
+
+    /// Shorthand for `set(Layer::Local, value)`, like a plain assignment.
+    LayeredProperty& operator=(T value) {
+        set(Layer::Local, std::move(value));
+        return *this;
+    }
+
+    /// Removes the value stored in `layer`; the default layer only resets to
+    /// a value-initialised `T`.
+    void clear(Layer layer) {
+        const std::uint8_t i = index(layer);
+        if (i == 0) {
+            set(Layer::Default, T{});
+            return;
+        }
+        if (!has(layer))
+            return;
+        set_ &= static_cast<std::uint8_t>(~(1u << i));
+        if (i != top_) {
+            values_[i] = T{};
+            return;
+        }
+        const std::uint8_t next = static_cast<std::uint8_t>(std::bit_width(set_) - 1);
+        if constexpr (std::equality_comparable<T>) {
+            if (values_[next] == values_[i]) {
+                top_ = next;
+                values_[i] = T{};
+                return;
+            }
+        }
+        sampling::ScopedSetter timer(bean_type_, name_, listeners_.size());
+        T old = std::exchange(values_[i], T{});
+        top_ = next;
+        listeners_.notify(old, values_[top_]);
+    }
+
+    ListenerId subscribe(Listener listener) { return listeners_.subscribe(std::move(listener)); }
+
+    /// Removes the listener registered under `id`; returns false if unknown.
+    bool unsubscribe(ListenerId id) { return listeners_.unsubscribe(id); }
+
+    std::size_t listener_count() const noexcept { return listeners_.size(); }
+
+    std::string_view bean_type() const noexcept { return bean_type_; }
+    std::string_view name() const noexcept { return name_; }
+
+private:
+    static constexpr std::uint8_t index(Layer layer) noexcept { return static_cast<std::uint8_t>(layer); }
+
+    /// Layer `i`, above the effective one, has just been set.
+    void raise(std::uint8_t i) {
+        const std::uint8_t old_top = std::exchange(top_, i);
+        if constexpr (std::equality_comparable<T>) {
+            if (values_[old_top] == values_[i])
+                return;
+        }
+        sampling::ScopedSetter timer(bean_type_, name_, listeners_.size());
+        listeners_.notify(values_[old_top], values_[i]);
+    }
+
+    T values_[layer_count]{};
+    std::uint8_t set_ = 1;  // Bit per layer; the default is always set.
+    std::uint8_t top_ = 0;  // Highest set layer: the source of the effective value.
+    std::string_view bean_type_;
+    std::string_view name_;
+    detail::ListenerList<const T&, const T&> listeners_;
+};
+
+}  // namespace beans
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+namespace beans {
+
+/// Describes one change to an observable sequence: elements `[from, to)`
+/// were inserted, removed (indices as they were before removal) or replaced.
+struct ListChange {
+    enum class Kind { Inserted, Removed, Replaced };
+
+    Kind kind;
+    std::size_t from;
+    std::size_t to;
+};
+
+}  // namespace beans
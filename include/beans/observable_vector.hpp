@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <utility>
+
+#include "detail/listeners.hpp"
+#include "detail/vector.hpp"
+#include "list_change.hpp"
+
+namespace beans {
+
+/// A vector that notifies listeners of every change, in the spirit of
+/// JavaFX's ObservableList.  Elements are read through const access and
+/// modified through the mutators, which each fire one `ListChange`.
+///
+/// Storage relocates trivially relocatable elements with realloc/memmove (see
+/// `is_trivially_relocatable`), so growth and erasure do not move beans one
+/// by one.
+template <class T>
+class ObservableVector {
+public:
+    using value_type = T;
+    using Listener = Function<void(const ObservableVector&, const ListChange&)>;
+
+    ObservableVector() = default;
+    ObservableVector(const ObservableVector&) = delete;
+    ObservableVector& operator=(const ObservableVector&) = delete;
+
+    std::size_t size() const noexcept { return items_.size(); }
+    bool empty() const noexcept { return items_.empty(); }
+    const T& operator[](std::size_t i) const noexcept { return items_[i]; }
+    const T* begin() const noexcept { return items_.begin(); }
+    const T* end() const noexcept { return items_.end(); }
+    std::span<const T> span() const noexcept { return {items_.data(), items_.size()}; }
+
+    void reserve(std::size_t n) { items_.reserve(n); }
+
+    template <class... Args>
+    const T& emplace_back(Args&&... args) {
+        items_.emplace_back(std::forward<Args>(args)...);
+        changed(ListChange::Kind::Inserted, items_.size() - 1, items_.size());
+        return items_.back();
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    template <class... Args>
+    const T& insert(std::size_t pos, Args&&... args) {
+        const T& inserted = items_.emplace(pos, std::forward<Args>(args)...);
+        changed(ListChange::Kind::Inserted, pos, pos + 1);
+        return inserted;
+    }
+
+    void set(std::size_t i, T value) {
+        items_[i] = std::move(value);
+        changed(ListChange::Kind::Replaced, i, i + 1);
+    }
+
+    void erase(std::size_t i) { erase(i, i + 1); }
+
+    void erase(std::size_t first, std::size_t last) {
+        if (first >= last)
+            return;
+        items_.erase(first, last);
+        changed(ListChange::Kind::Removed, first, last);
+    }
+
+    void clear() { erase(0, items_.size()); }
+
+    ListenerId subscribe(Listener listener) { return listeners_.subscribe(std::move(listener)); }
+    bool unsubscribe(ListenerId id) { return listeners_.unsubscribe(id); }
+    std::size_t listener_count() const noexcept { return listeners_.size(); }
+
+private:
+    void changed(ListChange::Kind kind, std::size_t from, std::size_t to) {
+        if (!listeners_.empty())
+            listeners_.notify(*this, ListChange{kind, from, to});
+    }
+
+    detail::Vector<T> items_;
+    detail::ListenerList<const ObservableVector&, const ListChange&> listeners_;
+};
+
+}  // namespace beans
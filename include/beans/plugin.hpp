@@ -0,0 +1,414 @@
+#pragma once
+
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "c/plugin.h"
+#include "c_api.hpp"
+#include "descriptor.hpp"
+#include "reflect.hpp"
+
+namespace beans {
+
+/// Thrown when a plugin cannot be loaded or registers a malformed type.
+class PluginError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/// Resolved access to one field of a plugin type.  It holds the field's byte
+/// offset, so reading through it costs the same as a member access.
+template <class T>
+class FieldHandle {
+public:
+    FieldHandle() noexcept = default;
+
+    bool valid() const noexcept { return offset_ != invalid; }
+    explicit operator bool() const noexcept { return valid(); }
+
+    T& operator()(void* bean) const noexcept {
+        return *std::launder(reinterpret_cast<T*>(static_cast<std::byte*>(bean) + offset_));
+    }
+    const T& operator()(const void* bean) const noexcept {
+        return *std::launder(reinterpret_cast<const T*>(static_cast<const std::byte*>(bean) + offset_));
+    }
+
+private:
+    friend class PluginType;
+    static constexpr std::size_t invalid = static_cast<std::size_t>(-1);
+
+    explicit FieldHandle(std::size_t offset) noexcept : offset_(offset) {}
+
+    std::size_t offset_ = invalid;
+};
+
+class DynamicBean;
+
+/// A bean type registered at runtime, usually by a plugin.
+class PluginType {
+public:
+    struct Field {
+        std::string_view name;
+        std::uint64_t hash;
+        FieldKind kind;
+        std::size_t size;
+        std::size_t offset;
+    };
+
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    explicit PluginType(const beans_type_info& info, const void* owner) : info_(info), owner_(owner) {
+        const beans_type& type = *info.type;
+        name_ = {type.name.data, type.name.size};
+        fields_.reserve(type.field_count);
+        for (std::size_t i = 0; i < type.field_count; ++i) {
+            const beans_field& f = type.fields[i];
+            // A field without an offset cannot be accessed in place.
+            const auto kind = f.kind <= BEANS_KIND_OTHER && info.offsets[i] != SIZE_MAX
+                                  ? static_cast<FieldKind>(f.kind)
+                                  : FieldKind::Other;
+            fields_.push_back({{f.name.data, f.name.size}, f.hash, kind, f.size, info.offsets[i]});
+        }
+        by_hash_.resize(fields_.size());
+        for (std::size_t i = 0; i < by_hash_.size(); ++i)
+            by_hash_[i] = i;
+        std::sort(by_hash_.begin(), by_hash_.end(),
+                  [&](std::size_t a, std::size_t b) { return fields_[a].hash < fields_[b].hash; });
+    }
+
+    PluginType(const PluginType&) = delete;
+    PluginType& operator=(const PluginType&) = delete;
+
+    std::string_view name() const noexcept { return name_; }
+    std::size_t size() const noexcept { return info_.size; }
+    std::size_t align() const noexcept { return info_.align; }
+    std::span<const Field> fields() const noexcept { return fields_; }
+    bool copyable() const noexcept { return info_.copy != nullptr; }
+
+    /// True if this type was registered from `c::type_info<T>()` in this
+    /// binary, so its beans can be used as `T` directly.
+    template <Reflectable T>
+    bool is() const noexcept {
+        return info_.type == c::detail::c_type<T>();
+    }
+
+    /// Index of the field called `name`, or `npos`.
+    std::size_t index_of(const FieldName& name) const noexcept {
+        auto it = std::lower_bound(by_hash_.begin(), by_hash_.end(), name.hash,
+                                   [&](std::size_t i, std::uint64_t h) { return fields_[i].hash < h; });
+        for (; it != by_hash_.end() && fields_[*it].hash == name.hash; ++it)
+            if (fields_[*it].name == name.text)
+                return *it;
+        return npos;
+    }
+
+    /// Resolves field `name` for typed access.  The handle is invalid if
+    /// there is no such field or its kind does not match `T`.  Resolve once
+    /// and keep the handle; using it involves no lookup.
+    template <class T>
+    FieldHandle<T> field(const FieldName& name) const noexcept {
+        constexpr FieldKind kind = field_kind_v<T>;
+        const std::size_t i = index_of(name);
+        if (i == npos || kind == FieldKind::Other || fields_[i].kind != kind || fields_[i].size != sizeof(T))
+            return {};
+        return FieldHandle<T>(fields_[i].offset);
+    }
+
+    DynamicBean create() const;
+
+private:
+    friend class DynamicBean;
+    friend class TypeRegistry;
+
+    beans_type_info info_;
+    const void* owner_;
+    std::string_view name_;
+    std::vector<Field> fields_;
+    std::vector<std::size_t> by_hash_;
+};
+
+/// An owned bean of a `PluginType`.  The type, and the plugin providing it,
+/// must outlive the bean.
+class DynamicBean {
+public:
+    explicit DynamicBean(const PluginType& type) : type_(&type), data_(allocate(type)) {
+        try {
+            type.info_.construct(data_);
+        } catch (...) {
+            deallocate(type, data_);
+            throw;
+        }
+    }
+
+    DynamicBean(DynamicBean&& other) noexcept
+        : type_(other.type_), data_(std::exchange(other.data_, nullptr)) {}
+
+    DynamicBean& operator=(DynamicBean&& other) noexcept {
+        if (this != &other) {
+            reset();
+            type_ = other.type_;
+            data_ = std::exchange(other.data_, nullptr);
+        }
+        return *this;
+    }
+
+    DynamicBean(const DynamicBean&) = delete;
+    DynamicBean& operator=(const DynamicBean&) = delete;
+
+    ~DynamicBean() { reset(); }
+
+    /// Copies the bean; throws `PluginError` if the type is not copyable.
+    DynamicBean clone() const {
+        if (!type_->info_.copy)
+            throw PluginError("bean type '" + std::string(type_->name()) + "' is not copyable");
+        void* data = allocate(*type_);
+        try {
+            type_->info_.copy(data, data_);
+        } catch (...) {
+            deallocate(*type_, data);
+            throw;
+        }
+        return DynamicBean(*type_, data);
+    }
+
+    const PluginType& type() const noexcept { return *type_; }
+    void* data() noexcept { return data_; }
+    const void* data() const noexcept { return data_; }
+
+    template <class T>
+    T& operator[](const FieldHandle<T>& field) noexcept {
+        return field(data_);
+    }
+    template <class T>
+    const T& operator[](const FieldHandle<T>& field) const noexcept {
+        return field(static_cast<const void*>(data_));
+    }
+
+private:
+    DynamicBean(const PluginType& type, void* data) noexcept : type_(&type), data_(data) {}
+
+    static void* allocate(const PluginType& type) {
+        return ::operator new(std::max<std::size_t>(type.size(), 1), std::align_val_t(type.align()));
+    }
+
+    static void deallocate(const PluginType& type, void* data) noexcept {
+        ::operator delete(data, std::align_val_t(type.align()));
+    }
+
+    void reset() noexcept {
+        if (data_) {
+            type_->info_.destroy(data_);
+            deallocate(*type_, data_);
+            data_ = nullptr;
+        }
+    }
+
+    const PluginType* type_;
+    void* data_;
+};
+
+inline DynamicBean PluginType::create() const { return DynamicBean(*this); }
+
+/// The bean types known at runtime, by name.  Types are registered directly
+/// with `add()` or by loading a `Plugin`.  Registered types never move, so
+/// pointers returned by `find()` may be cached until the type is removed.
+class TypeRegistry {
+public:
+    TypeRegistry() = default;
+    TypeRegistry(const TypeRegistry&) = delete;
+    TypeRegistry& operator=(const TypeRegistry&) = delete;
+
+    /// Registers a type; throws `PluginError` if it is malformed or its name
+    /// is taken.  `owner` tags the type for `remove_owned_by()`.
+    const PluginType& add(const beans_type_info& info, const void* owner = nullptr) {
+        validate(info);
+        const std::string_view name(info.type->name.data, info.type->name.size);
+        if (find(name))
+            throw PluginError("bean type '" + std::string(name) + "' is already registered");
+        types_.push_back(std::make_unique<PluginType>(info, owner));
+        hashes_.push_back(name_hash(name));
+        return *types_.back();
+    }
+
+    /// The type called `name`, or nullptr.
+    const PluginType* find(const FieldName& name) const noexcept {
+        for (std::size_t i = 0; i < types_.size(); ++i)
+            if (hashes_[i] == name.hash && types_[i]->name() == name.text)
+                return types_[i].get();
+        return nullptr;
+    }
+
+    std::size_t size() const noexcept { return types_.size(); }
+
+    /// Removes every type registered with `owner`.
+    void remove_owned_by(const void* owner) noexcept {
+        std::size_t out = 0;
+        for (std::size_t i = 0; i < types_.size(); ++i) {
+            if (types_[i]->owner_ == owner)
+                continue;
+            types_[out] = std::move(types_[i]);
+            hashes_[out++] = hashes_[i];
+        }
+        types_.resize(out);
+        hashes_.resize(out);
+    }
+
+    /// A registrar that adds types to this registry on behalf of `owner`.
+    /// `owner` must stay valid while the registrar is in use.
+    struct Registrar {
+        TypeRegistry* registry;
+        const void* owner;
+        beans_registrar c;
+    };
+
+    void init_registrar(Registrar& r, const void* owner) noexcept {
+        r.registry = this;
+        r.owner = owner;
+        r.c = {BEANS_ABI_VERSION, &r, &register_type};
+    }
+
+private:
+    static int register_type(void* self, const beans_type_info* info) noexcept {
+        auto* r = static_cast<Registrar*>(self);
+        try {
+            r->registry->add(*info, r->owner);
+            return 0;
+        } catch (...) {
+            return 1;
+        }
+    }
+
+    static void validate(const beans_type_info& info) {
+        const beans_type* type = info.type;
+        if (!type || !type->name.data || (type->field_count && (!type->fields || !info.offsets)) ||
+            !info.construct || !info.destroy || info.align == 0 || (info.align & (info.align - 1)))
+            throw PluginError("malformed bean type registration");
+        for (std::size_t i = 0; i < type->field_count; ++i) {
+            const std::size_t offset = info.offsets[i];
+            if (offset == SIZE_MAX)
+                continue;
+            if (offset > info.size || info.size - offset < type->fields[i].size)
+                throw PluginError("field outside bean in type '" +
+                                  std::string(type->name.data, type->name.size) + "'");
+        }
+    }
+
+    std::vector<std::unique_ptr<PluginType>> types_;
+    std::vector<std::uint64_t> hashes_;
+};
+
+/// A loaded plugin.  Loading calls the plugin's `beans_plugin_register`,
+/// which adds its bean types to `registry`; destroying the plugin removes
+/// them again and unloads the shared object.  Beans of the plugin's types
+/// must be destroyed first.
+class Plugin {
+public:
+    Plugin(const std::string& path, TypeRegistry& registry) : registry_(&registry) {
+        handle_ = ::dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!handle_)
+            throw PluginError(::dlerror());
+        auto entry = reinterpret_cast<beans_plugin_register_fn>(::dlsym(handle_, BEANS_PLUGIN_ENTRY));
+        if (!entry) {
+            ::dlclose(handle_);
+            throw PluginError(path + ": no " BEANS_PLUGIN_ENTRY " entry point");
+        }
+        TypeRegistry::Registrar registrar;
+        registry.init_registrar(registrar, this);
+        if (entry(&registrar.c) != 0) {
+            registry.remove_owned_by(this);
+            ::dlclose(handle_);
+            throw PluginError(path + ": plugin registration failed");
+        }
+    }
+
+    Plugin(const Plugin&) = delete;
+    Plugin& operator=(const Plugin&) = delete;
+
+    ~Plugin() {
+        registry_->remove_owned_by(this);
+        ::dlclose(handle_);
+    }
+
+private:
+    TypeRegistry* registry_;
+    void* handle_ = nullptr;
+};
+
+namespace c {
+
+namespace detail {
+
+template <Reflectable T>
+struct TypeInfo {
+    std::array<std::size_t, field_count_v<T>> offsets{};
+    beans_type_info info{};
+
+    TypeInfo() {
+        // Offsets are measured on a live bean, which also covers beans whose
+        // storage order differs from their declared order.  Fields without a
+        // fixed address get no offset, and neither do nullable fields, which
+        // a write through an offset would leave null.
+        constexpr auto in_place = []<std::size_t... I>(std::index_sequence<I...>) {
+            return std::array<bool, field_count_v<T>>{(field_addressable_v<T, I> && !field_nullable_v<T, I>)...};
+        }(std::make_index_sequence<field_count_v<T>>{});
+        const T probe{};
+        const auto* base = reinterpret_cast<const std::byte*>(&probe);
+        const BeanDescriptor& d = descriptor_of<T>();
+        for (std::size_t i = 0; i < offsets.size(); ++i)
+            offsets[i] = in_place[i]
+                             ? static_cast<std::size_t>(static_cast<const std::byte*>(d.fields[i].get(&probe)) - base)
+                             : static_cast<std::size_t>(-1);
+        info.type = c_type<T>();
+        info.offsets = offsets.data();
+        info.size = sizeof(T);
+        info.align = alignof(T);
+        info.construct = [](void* memory) { ::new (memory) T(); };
+        info.destroy = [](void* bean) { static_cast<T*>(bean)->~T(); };
+        if constexpr (std::is_copy_constructible_v<T>)
+            info.copy = [](void* memory, const void* bean) { ::new (memory) T(*static_cast<const T*>(bean)); };
+    }
+};
+
+}  // namespace detail
+
+/// The plugin ABI description of `T`, built once.
+template <Reflectable T>
+const beans_type_info* type_info() {
+    static const detail::TypeInfo<T> info;
+    return &info.info;
+}
+
+/// Registers each of `Ts` with `registrar`; returns 0 on success.
+template <Reflectable... Ts>
+int register_types(const beans_registrar* registrar) {
+    try {
+        int rc = 0;
+        ((rc = rc ? rc : registrar->register_type(registrar->self, type_info<Ts>())), ...);
+        return rc;
+    } catch (...) {
+        return 1;
+    }
+}
+
+}  // namespace c
+}  // namespace beans
+
+/// Defines a plugin's entry point, exported even under -fvisibility=hidden
+/// (which plugins should use; see <beans/c/plugin.h>):
+///
+///     BEANS_PLUGIN { return beans::c::register_types<Quote, Order>(registrar); }
+#define BEANS_PLUGIN                                           \
+    extern "C" __attribute__((visibility("default"))) int      \
+    beans_plugin_register(const beans_registrar* registrar)
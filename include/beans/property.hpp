@@ -0,0 +1,74 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <string_view>
+#include <utility>
+
+#include "detail/listeners.hpp"
+#include "function.hpp"
+#include "sampling.hpp"
+
+namespace beans {
+
+/// An observable value, in the spirit of JavaBeans bound properties.
+///
+/// `set()` stores the new value and, if it differs from the old one, notifies
+/// every listener with `(old_value, new_value)`.  Listeners may subscribe or
+/// unsubscribe from inside a notification; listeners added during a
+/// notification are first called on the next change.
+///
+/// A property is not thread-safe; synchronise externally if it is shared.
+template <class T>
+class Property {
+public:
+    using value_type = T;
+    using Listener = Function<void(const T& old_value, const T& new_value)>;
+
+    Property() = default;
+    explicit Property(T initial) : value_(std::move(initial)) {}
+
+    /// Names the property for diagnostics such as slow-setter sampling.  Both
+    /// strings must outlive the property; string literals are the usual choice.
+    Property(std::string_view bean_type, std::string_view name, T initial = T{})
+        : value_(std::move(initial)), bean_type_(bean_type), name_(name) {}
+
+    Property(const Property&) = delete;
+    Property& operator=(const Property&) = delete;
+
+    const T& get() const noexcept { return value_; }
+    operator const T&() const noexcept { return value_; }
+
+    void set(T value) {
+        if constexpr (std::equality_comparable<T>) {
+            if (value_ == value)
+                return;
+        }
+        sampling::ScopedSetter timer(bean_type_, name_, listeners_.size());
+        T old = std::exchange(value_, std::move(value));
+        listeners_.notify(old, value_);
+    }
+
+    Property& operator=(T value) {
+        set(std::move(value));
+        return *this;
+    }
+
+    ListenerId subscribe(Listener listener) { return listeners_.subscribe(std::move(listener)); }
+
+    /// Removes the listener registered under `id`; returns false if unknown.
+    bool unsubscribe(ListenerId id) { return listeners_.unsubscribe(id); }
+
+    std::size_t listener_count() const noexcept { return listeners_.size(); }
+
+    std::string_view bean_type() const noexcept { return bean_type_; }
+    std::string_view name() const noexcept { return name_; }
+
+private:
+    T value_{};
+    std::string_view bean_type_;
+    std::string_view name_;
+    detail::ListenerList<const T&, const T&> listeners_;
+};
+
+}  // namespace beans
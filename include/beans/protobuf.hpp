@@ -0,0 +1,551 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "descriptor.hpp"
+#include "detail/wire.hpp"
+#include "reflect.hpp"
+
+// Protobuf wire-format codec for beans, driven by their descriptors: field
+// `I` is protobuf field `descriptor_of<T>().fields[I].number` (see
+// `field_number_v` and the `beans::Number<N>` field option).  Mapping:
+//
+// - bool, integers and enums: varint (int32/int64/uint32/uint64/bool/enum;
+//   8- and 16-bit integers travel as their 32-bit counterparts)
+// - float: fixed32, double: fixed64
+// - std::string: bytes/string
+// - a reflectable bean: a nested message
+// - std::vector of the above: a repeated field, packed for numbers
+//
+// Encoding follows proto3 implicit presence: default-valued fields are
+// omitted.  Decoding merges into the bean it is given, skips unknown
+// fields and accepts packed and unpacked repeated numbers.
+
+namespace beans::protobuf {
+
+/// Protobuf wire types used by the codec.  Groups (3 and 4) are deprecated
+/// and rejected.
+enum class WireType : std::uint8_t { Varint = 0, Fixed64 = 1, Length = 2, Fixed32 = 5 };
+
+namespace detail {
+
+using beans::detail::get_varint;
+using beans::detail::varint_size;
+using beans::detail::write_varint;
+
+template <class T>
+struct is_vector : std::false_type {};
+template <class T, class A>
+struct is_vector<std::vector<T, A>> : std::true_type {};
+
+/// Numbers, bools and enums: varints, or fixed32/fixed64 for floating point.
+template <class F>
+concept Scalar = std::is_integral_v<F> || std::is_enum_v<F> || std::is_same_v<F, float> || std::is_same_v<F, double>;
+
+template <class F>
+concept Message = Reflectable<F> && !Scalar<F> && !is_vector<F>::value && !std::is_same_v<F, std::string>;
+
+template <class F>
+concept Single = Scalar<F> || std::is_same_v<F, std::string> || Message<F>;
+
+/// Types with a protobuf mapping: scalars, strings, nested beans (as
+/// sub-messages) and vectors of those (as repeated fields).
+template <class F>
+concept Encodable = Single<F> || (is_vector<F>::value && Single<typename F::value_type>);
+
+template <Scalar F>
+constexpr WireType scalar_wire_type() noexcept {
+    if constexpr (std::is_same_v<F, float>)
+        return WireType::Fixed32;
+    else if constexpr (std::is_floating_point_v<F>)
+        return WireType::Fixed64;
+    else
+        return WireType::Varint;
+}
+
+template <Encodable F>
+constexpr WireType wire_type() noexcept {
+    if constexpr (Scalar<F>)
+        return scalar_wire_type<F>();
+    else
+        return WireType::Length;
+}
+
+/// Varint encoding of an integral, bool or enum value.  Signed values are
+/// sign-extended to 64 bits, as protobuf's int32 and int64 are.
+template <Scalar F>
+constexpr std::uint64_t to_varint(F v) noexcept {
+    if constexpr (std::is_enum_v<F>)
+        return to_varint(static_cast<std::underlying_type_t<F>>(v));
+    else if constexpr (std::is_signed_v<F>)
+        return static_cast<std::uint64_t>(static_cast<std::int64_t>(v));
+    else
+        return static_cast<std::uint64_t>(v);
+}
+
+template <Scalar F>
+constexpr F from_varint(std::uint64_t v) noexcept {
+    if constexpr (std::is_same_v<F, bool>)
+        return v != 0;
+    else if constexpr (std::is_enum_v<F>)
+        return static_cast<F>(from_varint<std::underlying_type_t<F>>(v));
+    else
+        return static_cast<F>(v);  // Truncates, as protobuf does for int32.
+}
+
+template <class U>
+U to_little_endian(U v) noexcept {
+    if constexpr (std::endian::native == std::endian::big) {
+        U r = 0;
+        for (std::size_t i = 0; i < sizeof(U); ++i, v >>= 8)
+            r = static_cast<U>((r << 8) | (v & 0xff));
+        return r;
+    }
+    return v;
+}
+
+template <class F>
+using bits_t = std::conditional_t<sizeof(F) == 4, std::uint32_t, std::uint64_t>;
+
+/// A precomputed tag: the varint of `number << 3 | wire type`.
+struct Tag {
+    std::array<char, 5> bytes{};
+    std::size_t size = 0;
+};
+
+constexpr Tag make_tag(std::uint32_t number, WireType wire) noexcept {
+    std::uint64_t v = (std::uint64_t{number} << 3) | static_cast<std::uint8_t>(wire);
+    Tag tag;
+    while (v >= 0x80) {
+        tag.bytes[tag.size++] = static_cast<char>((v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+    tag.bytes[tag.size++] = static_cast<char>(v);
+    return tag;
+}
+
+/// Field number of field `I`, from the descriptor so generated beans and
+/// reflected aggregates are numbered alike.
+template <Reflectable T, std::size_t I>
+inline constexpr std::uint32_t number_v = descriptor_of<T>().fields[I].number != 0
+                                              ? descriptor_of<T>().fields[I].number
+                                              : static_cast<std::uint32_t>(I + 1);
+
+template <Reflectable T>
+constexpr bool valid_numbers() noexcept {
+    constexpr std::size_t n = field_count_v<T>;
+    const std::array<std::uint32_t, n> numbers = []<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<std::uint32_t, n>{number_v<T, I>...};
+    }(std::make_index_sequence<n>{});
+    for (std::size_t i = 0; i < n; ++i) {
+        if (numbers[i] < 1 || numbers[i] > 536870911)
+            return false;
+        for (std::size_t j = 0; j < i; ++j)
+            if (numbers[i] == numbers[j])
+                return false;
+    }
+    return true;
+}
+
+template <Reflectable T>
+constexpr void check_message() noexcept {
+    static_assert([]<std::size_t... I>(std::index_sequence<I...>) {
+        return (Encodable<field_t<T, I>> && ...);
+    }(std::make_index_sequence<field_count_v<T>>{}),
+                  "every field must be a number, bool, enum, std::string, bean or std::vector of those");
+    static_assert(valid_numbers<T>(), "field numbers must be unique and between 1 and 2^29 - 1");
+}
+
+template <Reflectable T>
+std::size_t message_size(const T& bean) noexcept;
+template <Reflectable T>
+char* write_message(char* p, const T& bean) noexcept;
+template <Reflectable T>
+bool read_message(std::string_view in, T& bean);
+
+// --- Sizes -----------------------------------------------------------------
+
+/// Size of a value's payload, after its tag: the varint, the fixed bytes, or
+/// the length prefix and bytes.
+template <class F>
+std::size_t value_size(const F& v) noexcept {
+    if constexpr (Scalar<F>) {
+        if constexpr (scalar_wire_type<F>() == WireType::Varint)
+            return varint_size(to_varint(v));
+        else
+            return sizeof(F);
+    } else if constexpr (std::is_same_v<F, std::string>) {
+        return varint_size(v.size()) + v.size();
+    } else {
+        const std::size_t n = message_size(v);
+        return varint_size(n) + n;
+    }
+}
+
+/// Proto3 implicit presence: zero numbers, false, and empty strings and
+/// vectors are not written.  Floating point zero is compared bitwise, so
+/// -0.0 is kept.
+template <class F>
+bool is_default(const F& v) noexcept {
+    if constexpr (std::is_floating_point_v<F>)
+        return std::bit_cast<bits_t<F>>(v) == 0;
+    else if constexpr (Scalar<F>)
+        return v == F{};
+    else if constexpr (std::is_same_v<F, std::string> || is_vector<F>::value)
+        return v.empty();
+    else
+        return false;  // Nested beans are always present.
+}
+
+template <class E>
+std::size_t packed_size(const std::vector<E>& v) noexcept {
+    if constexpr (scalar_wire_type<E>() != WireType::Varint) {
+        return v.size() * sizeof(E);
+    } else {
+        std::size_t n = 0;
+        for (const E e : v)
+            n += varint_size(to_varint(e));
+        return n;
+    }
+}
+
+template <Reflectable T, std::size_t I>
+std::size_t field_size(const T& bean) noexcept {
+    using F = field_t<T, I>;
+    const F& v = beans::get<I>(bean);
+    if (is_default(v))
+        return 0;
+    constexpr std::size_t tag_size = make_tag(number_v<T, I>, wire_type<F>()).size;
+    if constexpr (!is_vector<F>::value) {
+        return tag_size + value_size(v);
+    } else if constexpr (Scalar<typename F::value_type>) {
+        const std::size_t n = packed_size(v);
+        return tag_size + varint_size(n) + n;
+    } else {
+        constexpr std::size_t element_tag_size =
+            make_tag(number_v<T, I>, wire_type<typename F::value_type>()).size;
+        std::size_t n = v.size() * element_tag_size;
+        for (const auto& e : v)
+            n += value_size(e);
+        return n;
+    }
+}
+
+template <Reflectable T>
+std::size_t message_size(const T& bean) noexcept {
+    return [&]<std::size_t... I>(std::index_sequence<I...>) {
+        return (field_size<T, I>(bean) + ... + 0);
+    }(std::make_index_sequence<field_count_v<T>>{});
+}
+
+// --- Encoding --------------------------------------------------------------
+
+template <std::uint32_t Number, WireType Wire>
+char* write_tag(char* p) noexcept {
+    static constexpr Tag tag = make_tag(Number, Wire);
+    std::memcpy(p, tag.bytes.data(), tag.size);
+    return p + tag.size;
+}
+
+template <class F>
+char* write_value(char* p, const F& v) noexcept {
+    if constexpr (Scalar<F>) {
+        if constexpr (scalar_wire_type<F>() == WireType::Varint) {
+            return write_varint(p, to_varint(v));
+        } else {
+            const auto bits = to_little_endian(std::bit_cast<bits_t<F>>(v));
+            std::memcpy(p, &bits, sizeof bits);
+            return p + sizeof bits;
+        }
+    } else if constexpr (std::is_same_v<F, std::string>) {
+        p = write_varint(p, v.size());
+        if (!v.empty())
+            std::memcpy(p, v.data(), v.size());
+        return p + v.size();
+    } else {
+        return write_message(write_varint(p, message_size(v)), v);
+    }
+}
+
+template <Reflectable T, std::size_t I>
+char* write_field(char* p, const T& bean) noexcept {
+    using F = field_t<T, I>;
+    const F& v = beans::get<I>(bean);
+    if (is_default(v))
+        return p;
+    if constexpr (!is_vector<F>::value) {
+        return write_value(write_tag<number_v<T, I>, wire_type<F>()>(p), v);
+    } else if constexpr (Scalar<typename F::value_type>) {
+        using E = typename F::value_type;
+        p = write_varint(write_tag<number_v<T, I>, WireType::Length>(p), packed_size(v));
+        if constexpr (scalar_wire_type<E>() != WireType::Varint && std::endian::native == std::endian::little) {
+            std::memcpy(p, v.data(), v.size() * sizeof(E));  // Already in wire layout.
+            return p + v.size() * sizeof(E);
+        } else {
+            for (const E e : v)
+                p = write_value(p, e);
+            return p;
+        }
+    } else {
+        for (const auto& e : v)
+            p = write_value(write_tag<number_v<T, I>, WireType::Length>(p), e);
+        return p;
+    }
+}
+
+template <Reflectable T>
+char* write_message(char* p, const T& bean) noexcept {
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        ((p = write_field<T, I>(p, bean)), ...);
+    }(std::make_index_sequence<field_count_v<T>>{});
+    return p;
+}
+
+// --- Decoding --------------------------------------------------------------
+
+/// Sets every field of `bean` to the value a missing field decodes to:
+/// zero, false, empty, and nested beans cleared in turn.  Encoding leaves
+/// such values out, so a bean whose own defaults differ would otherwise
+/// decode them in their place.  Only fields that differ are written, so a
+/// nullable field stays null and a sparse one takes no entry.
+template <Reflectable T>
+void clear_message(T& bean);
+
+template <Reflectable T, std::size_t I>
+void clear_field(T& bean) {
+    using F = field_t<T, I>;
+    if constexpr (Message<F>)
+        clear_message(beans::get<I>(bean));
+    else if (!is_default(beans::get<I>(std::as_const(bean))))
+        beans::get<I>(bean) = F{};
+}
+
+template <Reflectable T>
+void clear_message(T& bean) {
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        (clear_field<T, I>(bean), ...);
+    }(std::make_index_sequence<field_count_v<T>>{});
+}
+
+template <class F>
+bool read_fixed(std::string_view& in, F& v) noexcept {
+    bits_t<F> bits;
+    if (!beans::detail::get_fixed(in, bits))
+        return false;
+    v = std::bit_cast<F>(to_little_endian(bits));
+    return true;
+}
+
+inline bool read_length(std::string_view& in, std::string_view& payload) noexcept {
+    std::uint64_t n = 0;
+    if (!get_varint(in, n) || n > in.size())
+        return false;
+    payload = in.substr(0, static_cast<std::size_t>(n));
+    in.remove_prefix(static_cast<std::size_t>(n));
+    return true;
+}
+
+/// Reads one value of wire type `wire_type<F>()` into `v`.
+template <Single F>
+bool read_value(std::string_view& in, F& v) {
+    if constexpr (Scalar<F>) {
+        if constexpr (scalar_wire_type<F>() == WireType::Varint) {
+            std::uint64_t raw = 0;
+            if (!get_varint(in, raw))
+                return false;
+            v = from_varint<F>(raw);
+            return true;
+        } else {
+            return read_fixed(in, v);
+        }
+    } else {
+        std::string_view payload;
+        if (!read_length(in, payload))
+            return false;
+        if constexpr (std::is_same_v<F, std::string>) {
+            v.assign(payload);
+            return true;
+        } else {
+            return read_message(payload, v);
+        }
+    }
+}
+
+/// Reads field `I`, merging as protobuf does: the last scalar wins, nested
+/// messages merge, repeated fields append and accept both packed and
+/// unpacked encodings.
+template <Reflectable T, std::size_t I>
+bool read_field(std::string_view& in, WireType wire, T& bean) {
+    using F = field_t<T, I>;
+    F& v = beans::get<I>(bean);
+    if constexpr (!is_vector<F>::value) {
+        return wire == wire_type<F>() && read_value(in, v);
+    } else {
+        using E = typename F::value_type;
+        if constexpr (Scalar<E>) {
+            if (wire == WireType::Length) {
+                std::string_view payload;
+                if (!read_length(in, payload))
+                    return false;
+                while (!payload.empty()) {
+                    E e{};
+                    if (!read_value(payload, e))
+                        return false;
+                    v.push_back(e);
+                }
+                return true;
+            }
+        }
+        if (wire != wire_type<E>())
+            return false;
+        E e{};
+        if constexpr (Message<E>)
+            clear_message(e);
+        if (!read_value(in, e))
+            return false;
+        v.push_back(std::move(e));
+        return true;
+    }
+}
+
+inline bool skip_field(std::string_view& in, WireType wire) noexcept {
+    std::uint64_t v = 0;
+    std::string_view payload;
+    switch (wire) {
+    case WireType::Varint: return get_varint(in, v);
+    case WireType::Fixed64: return beans::detail::get_fixed(in, v);
+    case WireType::Length: return read_length(in, payload);
+    case WireType::Fixed32: {
+        std::uint32_t v32 = 0;
+        return beans::detail::get_fixed(in, v32);
+    }
+    }
+    return false;
+}
+
+/// Field dispatch.  Small field numbers index a table directly; sparse
+/// numbers fall back to comparing against each field.
+template <Reflectable T>
+struct Dispatch {
+    using Reader = bool (*)(std::string_view&, WireType, T&);
+    static constexpr std::size_t n = field_count_v<T>;
+
+    static constexpr std::array<std::uint32_t, n> numbers = []<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<std::uint32_t, n>{number_v<T, I>...};
+    }(std::make_index_sequence<n>{});
+
+    static constexpr std::array<Reader, n> readers = []<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<Reader, n>{&read_field<T, I>...};
+    }(std::make_index_sequence<n>{});
+
+    static constexpr std::uint32_t max_number = [] {
+        std::uint32_t m = 0;
+        for (const std::uint32_t number : numbers)
+            m = number > m ? number : m;
+        return m;
+    }();
+
+    static constexpr bool direct = max_number < 256;
+
+    /// Field index + 1 by field number, or 0 for unknown numbers.
+    static constexpr auto by_number = [] {
+        std::array<std::uint16_t, direct ? max_number + 1 : 1> table{};
+        if constexpr (direct)
+            for (std::size_t i = 0; i < n; ++i)
+                table[numbers[i]] = static_cast<std::uint16_t>(i + 1);
+        return table;
+    }();
+
+    static Reader find(std::uint64_t number) noexcept {
+        if constexpr (direct) {
+            if (number <= max_number && by_number[number] != 0)
+                return readers[by_number[number] - 1];
+        } else {
+            for (std::size_t i = 0; i < n; ++i)
+                if (numbers[i] == number)
+                    return readers[i];
+        }
+        return nullptr;
+    }
+};
+
+template <Reflectable T>
+bool read_message(std::string_view in, T& bean) {
+    while (!in.empty()) {
+        std::uint64_t key = 0;
+        if (!get_varint(in, key))
+            return false;
+        const auto wire = static_cast<WireType>(key & 7);
+        const std::uint64_t number = key >> 3;
+        if (number == 0)
+            return false;
+        if (const auto read = Dispatch<T>::find(number)) {
+            if (!read(in, wire, bean))
+                return false;
+        } else if (!skip_field(in, wire)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace detail
+
+/// Encoded size of `bean` in bytes.
+template <Reflectable T>
+std::size_t encoded_size(const T& bean) noexcept {
+    detail::check_message<T>();
+    return detail::message_size(bean);
+}
+
+/// Appends the encoding of `bean` to `out`.  The size is computed first so
+/// the output grows once and fields are written through a raw pointer.
+template <Reflectable T>
+void encode(const T& bean, std::string& out) {
+    detail::check_message<T>();
+    const std::size_t at = out.size();
+    const std::size_t n = detail::message_size(bean);
+    out.resize(at + n);
+    detail::write_message(out.data() + at, bean);
+}
+
+template <Reflectable T>
+std::string encode(const T& bean) {
+    std::string out;
+    encode(bean, out);
+    return out;
+}
+
+/// Merges the message in `in` into `bean`: fields the message holds are
+/// overwritten (or appended to, or merged, for repeated fields and nested
+/// beans) and the rest are left alone.  Returns false on malformed input or
+/// a wire type that does not match the field, leaving `bean` partially
+/// updated.  Writes go straight to the fields, so beans with change
+/// notification do not notify.
+template <Reflectable T>
+bool merge(std::string_view in, T& bean) {
+    detail::check_message<T>();
+    return detail::read_message(in, bean);
+}
+
+/// Decodes the message in `in` into `bean`.  Fields the message does not
+/// hold become zero, false or empty, as in proto3, whatever default the
+/// bean gives them: encoding leaves those values out, so this is what
+/// round-trips them.  Fails as `merge` does.
+template <Reflectable T>
+bool decode(std::string_view in, T& bean) {
+    detail::check_message<T>();
+    detail::clear_message(bean);
+    return detail::read_message(in, bean);
+}
+
+}  // namespace beans::protobuf
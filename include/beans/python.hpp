@@ -0,0 +1,54 @@
+#pragma once
+
+// Hands beans and bean tables to the `beans` Python module
+// (bindings/python).  Include from a CPython extension, after <Python.h>.
+
+#include <Python.h>
+
+#include <new>
+
+#include "c_api.hpp"
+
+namespace beans::python {
+
+/// Capsule names understood by `beans.Table` and `beans.Bean`.
+inline constexpr const char* table_capsule_name = "beans.table";
+inline constexpr const char* bean_capsule_name = "beans.bean";
+
+namespace detail {
+
+template <class Handle>
+void destroy_capsule(PyObject* capsule) noexcept {
+    delete static_cast<Handle*>(PyCapsule_GetPointer(capsule, PyCapsule_GetName(capsule)));
+}
+
+template <class Handle>
+PyObject* make_capsule(const Handle& handle, const char* name) {
+    auto* copy = new (std::nothrow) Handle(handle);
+    if (!copy)
+        return PyErr_NoMemory();
+    PyObject* capsule = PyCapsule_New(copy, name, &destroy_capsule<Handle>);
+    if (!capsule)
+        delete copy;
+    return capsule;
+}
+
+}  // namespace detail
+
+/// A new reference to a capsule describing `table`; pass it to
+/// `beans.Table(capsule)`.  The table must outlive every Python object
+/// created from the capsule.
+template <Reflectable T>
+PyObject* wrap(BeanTable<T>& table) {
+    return detail::make_capsule(c::export_table(table), table_capsule_name);
+}
+
+/// A new reference to a capsule describing `bean`; pass it to
+/// `beans.Bean(capsule)`.  The bean must outlive every Python object created
+/// from the capsule.
+template <Reflectable T>
+PyObject* wrap(T& bean) {
+    return detail::make_capsule(c::export_bean(bean), bean_capsule_name);
+}
+
+}  // namespace beans::python
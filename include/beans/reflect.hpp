@@ -0,0 +1,308 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "descriptor.hpp"
+#include "detail/aggregate.hpp"
+#include "fixed_string.hpp"
+
+namespace beans {
+
+namespace detail {
+
+template <class T>
+consteval std::string_view raw_type_name() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return __FUNCSIG__;
+#else
+    return __PRETTY_FUNCTION__;
+#endif
+}
+
+/// Extracts the spelling of `T` from the compiler's function signature.
+template <class T>
+consteval std::string_view type_name() noexcept {
+    const std::string_view sig = raw_type_name<T>();
+#if defined(_MSC_VER) && !defined(__clang__)
+    std::size_t begin = sig.find("raw_type_name<") + 14;
+    const std::size_t end = sig.rfind(">(void)");
+    for (std::string_view prefix : {"struct ", "class ", "union ", "enum "})
+        if (sig.substr(begin, prefix.size()) == prefix)
+            begin += prefix.size();
+#else
+    const std::size_t begin = sig.find("T = ") + 4;
+    const std::size_t end = sig.find_first_of(";]", begin);
+#endif
+    return sig.substr(begin, end - begin);
+}
+
+template <class T>
+struct fake_wrapper {
+    const T value;
+};
+
+/// Never defined: only its members' addresses are taken, at compile time.
+template <class T>
+extern const fake_wrapper<T> fake_object;
+
+template <auto Ptr>
+consteval std::string_view raw_member_name() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return __FUNCSIG__;
+#else
+    return __PRETTY_FUNCTION__;
+#endif
+}
+
+constexpr bool is_identifier_char(char c) noexcept {
+    return c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+/// Extracts the member name from a signature that spells a pointer to the
+/// member, e.g. `Ptr = (& fake_object<P>.value.P::price)` on GCC or
+/// `Ptr = &fake_object.value.price` on Clang.
+template <auto Ptr>
+consteval std::string_view member_name() noexcept {
+    const std::string_view sig = raw_member_name<Ptr>();
+#if defined(_MSC_VER) && !defined(__clang__)
+    std::size_t end = sig.rfind(">(void)");
+#else
+    std::size_t end = sig.find_first_of(";]", sig.find("Ptr = "));
+#endif
+    while (end > 0 && !is_identifier_char(sig[end - 1]))
+        --end;
+    std::size_t begin = end;
+    while (begin > 0 && is_identifier_char(sig[begin - 1]))
+        --begin;
+    return sig.substr(begin, end - begin);
+}
+
+/// Reflection of plain aggregates: fields are found through structured
+/// bindings and named through the compiler's function signatures, so no
+/// registration is needed and everything resolves at compile time.
+template <class T>
+struct aggregate_traits {
+    static constexpr std::size_t size = aggregate_field_count<T>();
+    static_assert(size <= max_aggregate_fields, "too many fields for automatic reflection");
+    static_assert(size > 0, "automatic reflection found no fields");
+    // Decomposing with the wrong count is a compile error here rather than
+    // descriptors that silently miss or shift fields.
+    static_assert(std::tuple_size_v<decltype(tie_aggregate<size>(std::declval<T&>()))> == size,
+                  "aggregate field count does not match its structured bindings");
+
+    static constexpr std::string_view name = type_name<T>();
+
+    template <std::size_t I>
+    static constexpr auto& get(T& bean) noexcept {
+        return std::get<I>(tie_aggregate<size>(bean));
+    }
+    template <std::size_t I>
+    static constexpr const auto& get(const T& bean) noexcept {
+        return std::get<I>(tie_aggregate<size>(bean));
+    }
+
+    template <std::size_t I>
+    static constexpr std::string_view field_name = member_name<&get<I>(fake_object<T>.value)>();
+};
+
+template <class T>
+concept has_member_traits = requires { typename T::beans_traits; };
+
+}  // namespace detail
+
+/// Compile-time description of a bean type.  Plain aggregates are described
+/// automatically; other types opt in by naming a traits class as a nested
+/// `beans_traits` type, or by specialising this template.  A traits class
+/// provides `size`, `name`, `field_name<I>` and `get<I>(bean)`, and
+/// optionally `field_number<I>`, `field_addressable<I>`, `field_nullable<I>`
+/// and a constexpr
+/// `BeanDescriptor descriptor`.
+template <class T>
+struct bean_traits {};
+
+template <class T>
+    requires(std::is_class_v<T> && std::is_aggregate_v<T> && !detail::has_member_traits<T>)
+struct bean_traits<T> : detail::aggregate_traits<T> {};
+
+template <class T>
+    requires detail::has_member_traits<T>
+struct bean_traits<T> : T::beans_traits {};
+
+/// Types with a usable `bean_traits` specialisation.
+template <class T>
+concept Reflectable = requires {
+    { bean_traits<std::remove_cvref_t<T>>::size } -> std::convertible_to<std::size_t>;
+};
+
+template <Reflectable T>
+inline constexpr std::size_t field_count_v = bean_traits<T>::size;
+
+template <Reflectable T>
+inline constexpr std::string_view type_name_v = bean_traits<T>::name;
+
+template <Reflectable T, std::size_t I>
+inline constexpr std::string_view field_name_v = bean_traits<T>::template field_name<I>;
+
+/// Reference to field `I` (in declaration order) of `bean`.
+template <std::size_t I, Reflectable T>
+constexpr auto& get(T& bean) noexcept {
+    static_assert(I < field_count_v<std::remove_const_t<T>>, "field index out of range");
+    return bean_traits<std::remove_const_t<T>>::template get<I>(bean);
+}
+
+template <Reflectable T, std::size_t I>
+using field_t = std::remove_cvref_t<decltype(beans::get<I>(std::declval<T&>()))>;
+
+/// Wire field number of field `I`, as used by tagged formats such as
+/// protobuf.  Traits may assign numbers through `field_number<I>`; a field
+/// without one (or with 0) takes the number after the previous field's, so
+/// by default fields are numbered 1, 2, 3... in declaration order.
+template <Reflectable T, std::size_t I>
+inline constexpr std::uint32_t field_number_v = [] {
+    constexpr std::uint32_t assigned = [] {
+        if constexpr (requires { bean_traits<T>::template field_number<I>; })
+            return static_cast<std::uint32_t>(bean_traits<T>::template field_number<I>);
+        else
+            return std::uint32_t{0};
+    }();
+    if constexpr (assigned != 0)
+        return assigned;
+    else if constexpr (I == 0)
+        return std::uint32_t{1};
+    else
+        return field_number_v<T, I - 1> + 1;
+}();
+
+/// Whether field `I` lives at a fixed address inside the bean.  Traits set
+/// `field_addressable<I>` to false for fields stored elsewhere, such as
+/// sparse fields, whose mutable access allocates; descriptors report those
+/// as `FieldKind::Other` without an address.
+template <Reflectable T, std::size_t I>
+inline constexpr bool field_addressable_v = [] {
+    if constexpr (requires { bean_traits<T>::template field_addressable<I>; })
+        return static_cast<bool>(bean_traits<T>::template field_addressable<I>);
+    else
+        return true;
+}();
+
+/// Whether field `I` is nullable: it lives at a fixed address, but whether
+/// it holds a value is recorded elsewhere, so writing it in place leaves it
+/// null.  Traits report this as `field_nullable<I>`.
+template <Reflectable T, std::size_t I>
+inline constexpr bool field_nullable_v = [] {
+    if constexpr (requires { bean_traits<T>::template field_nullable<I>; })
+        return static_cast<bool>(bean_traits<T>::template field_nullable<I>);
+    else
+        return false;
+}();
+
+namespace detail {
+
+template <class T, std::size_t... I>
+constexpr std::size_t field_index(std::string_view name, std::index_sequence<I...>) noexcept {
+    std::size_t index = sizeof...(I);
+    ((field_name_v<T, I> == name ? (index = I, true) : false) || ...);
+    return index;
+}
+
+}  // namespace detail
+
+/// Declared index of the field called `name`, or `field_count_v<T>` if none.
+template <Reflectable T>
+constexpr std::size_t field_index_of(std::string_view name) noexcept {
+    return detail::field_index<T>(name, std::make_index_sequence<field_count_v<T>>{});
+}
+
+/// Declared index of the field called `Name`; does not compile if `T` has no
+/// such field.
+template <Reflectable T, FixedString Name>
+inline constexpr std::size_t field_index_v = [] {
+    constexpr std::size_t index = field_index_of<T>(Name.view());
+    static_assert(index < field_count_v<T>, "bean has no field with this name");
+    return index;
+}();
+
+/// Reference to the field called `Name`, resolved at compile time to a direct
+/// member access:  `beans::get<"price">(trade)`.
+template <FixedString Name, Reflectable T>
+constexpr auto& get(T& bean) noexcept {
+    return beans::get<field_index_v<std::remove_const_t<T>, Name>>(bean);
+}
+
+/// Calls `f(name, field)` for every field of `bean` in declaration order.
+template <Reflectable T, class F>
+constexpr void for_each_field(T& bean, F&& f) {
+    using U = std::remove_const_t<T>;
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        (f(field_name_v<U, I>, beans::get<I>(bean)), ...);
+    }(std::make_index_sequence<field_count_v<U>>{});
+}
+
+namespace detail {
+
+template <class T, std::size_t I>
+void* field_address(void* bean) noexcept {
+    return std::addressof(beans::get<I>(*static_cast<T*>(bean)));
+}
+
+template <class T, std::size_t I>
+const void* field_read(const void* bean) noexcept {
+    return std::addressof(beans::get<I>(*static_cast<const T*>(bean)));
+}
+
+template <class T, std::size_t... I>
+constexpr auto make_field_descriptors(std::index_sequence<I...>) noexcept {
+    return std::array<FieldDescriptor, sizeof...(I)>{FieldDescriptor{
+        field_name_v<T, I>, name_hash(field_name_v<T, I>),
+        field_addressable_v<T, I> ? field_kind_v<field_t<T, I>> : FieldKind::Other, I, sizeof(field_t<T, I>),
+        alignof(field_t<T, I>), field_addressable_v<T, I> ? &field_address<T, I> : nullptr,
+        field_number_v<T, I>, &field_read<T, I>}...};
+}
+
+template <class T>
+inline constexpr auto field_descriptors =
+    make_field_descriptors<T>(std::make_index_sequence<field_count_v<T>>{});
+
+/// Field indices sorted by name hash (insertion sort, evaluated at compile time).
+template <std::size_t N>
+constexpr std::array<std::uint16_t, N> make_hash_index(
+    const std::array<FieldDescriptor, N>& fields) noexcept {
+    static_assert(N <= 0xffff, "too many fields");
+    std::array<std::uint16_t, N> index{};
+    for (std::size_t i = 0; i < N; ++i)
+        index[i] = static_cast<std::uint16_t>(i);
+    for (std::size_t i = 1; i < N; ++i)
+        for (std::size_t j = i; j > 0 && fields[index[j]].hash < fields[index[j - 1]].hash; --j)
+            std::swap(index[j], index[j - 1]);
+    return index;
+}
+
+template <class T>
+inline constexpr auto hash_index = make_hash_index(field_descriptors<T>);
+
+template <class T>
+inline constexpr BeanDescriptor bean_descriptor{type_name_v<T>, field_descriptors<T>, sizeof(T),
+                                                alignof(T), hash_index<T>};
+
+}  // namespace detail
+
+/// Runtime descriptor for `T`, built entirely at compile time.  Traits may
+/// supply a ready-made `descriptor` (generated code does); otherwise one is
+/// derived from the traits.
+template <Reflectable T>
+constexpr const BeanDescriptor& descriptor_of() noexcept {
+    if constexpr (requires { bean_traits<T>::descriptor; })
+        return bean_traits<T>::descriptor;
+    else
+        return detail::bean_descriptor<T>;
+}
+
+}  // namespace beans
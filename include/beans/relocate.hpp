@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "reflect.hpp"
+
+namespace beans {
+
+/// A type is trivially relocatable when moving an object to a new address
+/// and destroying the original is equivalent to copying its bytes.  Containers
+/// then grow and erase with memcpy/memmove instead of element-wise move and
+/// destroy.
+///
+/// Detected automatically for trivially copyable types, for a few standard
+/// types known to qualify, for aggregates whose members and bases all
+/// qualify, and for declared beans whose fields all qualify and that add no
+/// members of their own.  Other types opt in with a member
+/// `using trivially_relocatable = std::true_type;` or by specialising this
+/// template; specialising to `std::false_type` opts a bean out, which is
+/// needed if it has a destructor that depends on the object's address.
+template <class T>
+struct is_trivially_relocatable;
+
+template <class T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+namespace detail {
+
+template <class T>
+struct known_relocatable : std::false_type {};
+
+template <class T>
+struct known_relocatable<std::unique_ptr<T>> : std::true_type {};
+
+template <class T>
+struct known_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+template <class T>
+struct known_relocatable<std::vector<T>> : std::true_type {};
+
+template <class T>
+struct known_relocatable<std::optional<T>> : is_trivially_relocatable<T> {};
+
+template <class A, class B>
+struct known_relocatable<std::pair<A, B>>
+    : std::bool_constant<is_trivially_relocatable_v<A> && is_trivially_relocatable_v<B>> {};
+
+#if defined(_LIBCPP_VERSION)
+// libc++ keeps short strings inline without a pointer to itself.  libstdc++
+// does point into the object, so its std::string must not be memcpy'd.
+template <>
+struct known_relocatable<std::string> : std::true_type {};
+#endif
+
+template <class T>
+concept has_relocatable_member = requires { T::trivially_relocatable::value; };
+
+template <class T, std::size_t... I>
+constexpr bool fields_relocatable(std::index_sequence<I...>) noexcept {
+    return (is_trivially_relocatable_v<field_t<T, I>> && ...);
+}
+
+/// Smallest size of a struct holding the reflected fields of `T`: sorted by
+/// decreasing alignment they need no padding but at the tail.
+template <class T, std::size_t... I>
+constexpr std::size_t packed_size(std::index_sequence<I...>) noexcept {
+    const std::size_t align = std::max({std::size_t{1}, alignof(field_t<T, I>)...});
+    const std::size_t bytes = (sizeof(field_t<T, I>) + ... + 0);
+    return (bytes + align - 1) / align * align;
+}
+
+/// Size of the storage behind the reflected fields of `T`: what its traits
+/// report (declared beans include their null mask and sparse side table),
+/// or else the fields packed.
+template <class T>
+constexpr std::size_t storage_size() noexcept {
+    if constexpr (requires { bean_traits<T>::storage_size(); })
+        return bean_traits<T>::storage_size();
+    else
+        return packed_size<T>(std::make_index_sequence<field_count_v<T>>{});
+}
+
+/// Whether every reflected field of `T` is trivially relocatable and the
+/// fields are all `T` holds.  Traits only describe the fields they declare,
+/// so a type bigger than their storage has members nothing vouches for (a
+/// class deriving from `Bean` and adding a `std::string`, say).  A bean with
+/// no reflected fields proves nothing (the fold would be vacuously true), so
+/// it does not qualify.
+template <class T>
+constexpr bool reflected_relocatable() noexcept {
+    if constexpr (field_count_v<T> == 0)
+        return false;
+    else
+        return sizeof(T) == storage_size<T>() &&
+               fields_relocatable<T>(std::make_index_sequence<field_count_v<T>>{});
+}
+
+/// Converts to the type of any member an aggregate initializer reaches, but
+/// only usably to trivially relocatable ones: converting to anything else
+/// is deleted, which fails the initializer rather than eliding braces into
+/// the member.  Nothing converts to a C array, so its elements are checked
+/// instead, and a base class takes an initializer just like a member.
+struct relocatable_field {
+    template <class U>
+        requires is_trivially_relocatable_v<U>
+    operator U() const noexcept;
+
+    template <class U>
+        requires(!is_trivially_relocatable_v<U>)
+    operator U() const = delete;
+};
+
+template <class T, std::size_t... I>
+constexpr bool initializers_relocatable(std::index_sequence<I...>) noexcept {
+    return requires { T{(static_cast<void>(I), relocatable_field{})...}; };
+}
+
+/// Whether every member and base of aggregate `T` is trivially relocatable.
+/// Probed through its initializer rather than its reflection, which would
+/// fail to compile for aggregates with a base class or a C array member.
+template <class T>
+constexpr bool aggregate_relocatable() noexcept {
+    constexpr std::size_t n = aggregate_field_count<T>();
+    if constexpr (n == 0 || n > max_aggregate_fields)
+        return false;
+    else
+        return initializers_relocatable<T>(std::make_index_sequence<n>{});
+}
+
+template <class T>
+constexpr bool default_relocatable() noexcept {
+    if constexpr (std::is_trivially_copyable_v<T>)
+        return true;
+    else if constexpr (has_relocatable_member<T>)
+        return T::trivially_relocatable::value;
+    else if constexpr (known_relocatable<T>::value)
+        return true;
+    else if constexpr (std::is_class_v<T> && std::is_aggregate_v<T> && !has_member_traits<T>)
+        return aggregate_relocatable<T>();
+    else if constexpr (std::is_class_v<T> && Reflectable<T>)
+        return reflected_relocatable<T>();
+    else
+        return false;
+}
+
+}  // namespace detail
+
+template <class T>
+struct is_trivially_relocatable : std::bool_constant<detail::default_relocatable<T>()> {};
+
+/// Moves `[first, last)` into the uninitialised storage at `dest` and ends
+/// the lifetime of the originals.  The ranges must not overlap.
+template <class T>
+void relocate(T* first, T* last, T* dest) noexcept(is_trivially_relocatable_v<T> ||
+                                                     std::is_nothrow_move_constructible_v<T>) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        if (first != last)
+            std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first),
+                        static_cast<std::size_t>(last - first) * sizeof(T));
+    } else {
+        std::uninitialized_move(first, last, dest);
+        std::destroy(first, last);
+    }
+}
+
+}  // namespace beans
@@ -0,0 +1,421 @@
+#pragma once
+
+#include <poll.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bean_table.hpp"
+#include "detail/socket.hpp"
+#include "detail/wire.hpp"
+#include "reflect.hpp"
+
+namespace beans {
+
+namespace detail {
+
+template <class U>
+inline constexpr bool replicable_field = std::is_same_v<U, std::string> || std::is_trivially_copyable_v<U>;
+
+template <class T, class Seq = std::make_index_sequence<field_count_v<T>>>
+struct replicable_fields;
+template <class T, std::size_t... I>
+struct replicable_fields<T, std::index_sequence<I...>>
+    : std::bool_constant<(replicable_field<field_t<T, I>> && ...)> {};
+
+template <class U>
+void put_value(std::string& out, const U& v) {
+    if constexpr (std::is_same_v<U, std::string>)
+        put_bytes(out, v);
+    else
+        put_fixed(out, v);
+}
+
+template <class U>
+bool get_value(std::string_view& in, U& v) {
+    if constexpr (std::is_same_v<U, std::string>)
+        return get_bytes(in, v);
+    else
+        return get_fixed(in, v);
+}
+
+/// Frame types of the replication protocol.  Every frame starts with one of
+/// these bytes.
+enum class ReplicationFrame : std::uint8_t {
+    Snapshot = 1,  ///< layout, sequence, row count, rows
+    Batch = 2,     ///< sequence after the batch, op count, ops
+    Ack = 3,       ///< sequence the follower has applied
+};
+
+/// Fingerprint of `T`'s fields, checked by followers against the snapshot.
+/// Sizes and alignments are mixed in as well, since rows are sent in each
+/// field's object representation.
+template <class T>
+constexpr std::uint64_t replication_layout() noexcept {
+    const BeanDescriptor& d = descriptor_of<T>();
+    std::uint64_t h = name_hash(d.name);
+    auto mix = [&h](std::uint64_t v) { h = (h ^ v) * 0x100000001b3ull; };
+    for (const FieldDescriptor& f : d.fields) {
+        mix(f.hash);
+        mix(static_cast<std::uint64_t>(f.kind));
+        mix(f.size);
+        mix(f.align);
+    }
+    return h;
+}
+
+template <class T>
+void put_row(std::string& out, const BeanTable<T>& table, std::size_t row) {
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        (put_value(out, table.template get<I>(row)), ...);
+    }(std::make_index_sequence<field_count_v<T>>{});
+}
+
+template <class T>
+bool get_row(std::string_view& in, T& bean) {
+    return [&]<std::size_t... I>(std::index_sequence<I...>) {
+        return (get_value(in, beans::get<I>(bean)) && ...);
+    }(std::make_index_sequence<field_count_v<T>>{});
+}
+
+inline int poll_timeout(std::chrono::milliseconds timeout) noexcept {
+    return static_cast<int>(std::min<std::chrono::milliseconds::rep>(timeout.count(), 1 << 30));
+}
+
+}  // namespace detail
+
+/// Bean types whose rows can be replicated: every field is a `std::string`
+/// or trivially copyable.
+template <class T>
+concept Replicable =
+    Reflectable<T> && std::is_default_constructible_v<T> && detail::replicable_fields<T>::value;
+
+struct ReplicationOptions {
+    /// A batch is sent once it reaches this size, even between polls.
+    std::size_t max_batch_bytes = 64 * 1024;
+    /// A follower with more unsent changes than this is disconnected; it
+    /// catches up from a snapshot when it reconnects.  This bounds both the
+    /// leader's memory and the follower's lag.  The snapshot a follower
+    /// starts with does not count, so a large table can still be followed.
+    std::size_t max_lag_bytes = 64 * 1024 * 1024;
+};
+
+/// Streams the changes of a `BeanTable` to followers on the same host.
+///
+/// Every change made through the table's mutators becomes an op in the
+/// current batch; `poll()` (or a full batch) sends the batch to every
+/// follower as one frame.  A new follower first receives a snapshot of the
+/// whole table.  Followers acknowledge what they have applied, which
+/// `max_lag()` reports.
+///
+/// The leader is driven by the thread that owns the table: call `poll()`
+/// regularly, e.g. from the same event loop that mutates the table.
+template <Replicable T>
+class ReplicationLeader {
+public:
+    ReplicationLeader(BeanTable<T>& table, Endpoint endpoint, ReplicationOptions options = {})
+        : table_(&table), endpoint_(std::move(endpoint)), options_(options),
+          listener_(detail::Socket::listen(endpoint_)) {
+        listener_id_ = table.subscribe(
+            [this](const BeanTable<T>&, const ListChange& change) { record(change); });
+    }
+
+    ReplicationLeader(const ReplicationLeader&) = delete;
+    ReplicationLeader& operator=(const ReplicationLeader&) = delete;
+
+    ~ReplicationLeader() {
+        table_->unsubscribe(listener_id_);
+        if (endpoint_.kind == Endpoint::Kind::Unix)
+            ::unlink(endpoint_.path.c_str());
+    }
+
+    /// Number of changes recorded so far.
+    std::uint64_t sequence() const noexcept { return sequence_; }
+
+    std::size_t follower_count() const noexcept { return followers_.size(); }
+
+    /// Changes not yet acknowledged by the slowest follower.
+    std::uint64_t max_lag() const noexcept {
+        std::uint64_t lag = 0;
+        for (const auto& f : followers_)
+            lag = std::max(lag, sequence_ - f->acked);
+        return lag;
+    }
+
+    /// Accepts followers, reads acknowledgements and sends the current batch,
+    /// waiting up to `timeout` for socket activity.  Throws
+    /// `std::length_error` if a snapshot of the table exceeds the 4 GiB frame
+    /// limit.
+    void poll(std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) {
+        flush();
+        std::vector<pollfd> fds;
+        fds.push_back({listener_.fd(), POLLIN, 0});
+        for (const auto& f : followers_) {
+            const short events = POLLIN | (f->conn.pending_output() ? POLLOUT : 0);
+            fds.push_back({f->conn.socket().fd(), events, 0});
+        }
+        if (::poll(fds.data(), fds.size(), detail::poll_timeout(timeout)) < 0 && errno != EINTR)
+            detail::throw_errno("poll");
+
+        for (std::size_t i = 0; i < followers_.size(); ++i) {
+            Follower& f = *followers_[i];
+            if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) {
+                bool ok = f.conn.receive();
+                f.conn.for_each_frame([&](std::string_view frame) { ok = ok && read_ack(f, frame); });
+                if (!ok)
+                    f.conn.close();
+            }
+            if (f.conn.open() && !f.conn.flush())
+                f.conn.close();
+        }
+        std::erase_if(followers_, [](const auto& f) { return !f->conn.open(); });
+
+        if (fds[0].revents & POLLIN) {
+            while (detail::Socket s = listener_.accept())
+                add_follower(std::move(s));
+        }
+    }
+
+    /// Closes the current batch and queues it for every follower.
+    void flush() {
+        if (ops_ == 0)
+            return;
+        for (auto& f : followers_) {
+            auto& conn = f->conn;
+            const std::size_t at = conn.begin_frame();
+            std::string& out = conn.output();
+            out.push_back(static_cast<char>(detail::ReplicationFrame::Batch));
+            detail::put_fixed(out, sequence_);
+            detail::put_varint(out, ops_);
+            out.append(batch_);
+            try {
+                conn.end_frame(at);
+            } catch (const std::length_error&) {
+                // A single op too large for a frame: the follower resyncs.
+                conn.close();
+                continue;
+            }
+            if (lag_bytes(*f) > options_.max_lag_bytes)
+                conn.close();
+        }
+        std::erase_if(followers_, [](const auto& f) { return !f->conn.open(); });
+        batch_.clear();
+        ops_ = 0;
+    }
+
+private:
+    struct Follower {
+        detail::FramedConnection conn;
+        std::uint64_t acked = 0;
+        std::uint64_t snapshot_end = 0;  // Stream offset just past the snapshot.
+    };
+
+    /// Unsent bytes queued after the follower's snapshot.
+    static std::size_t lag_bytes(const Follower& f) noexcept {
+        const std::uint64_t written = f.conn.written();
+        const std::uint64_t snapshot = f.snapshot_end > written ? f.snapshot_end - written : 0;
+        return f.conn.pending_output() - static_cast<std::size_t>(snapshot);
+    }
+
+    void record(const ListChange& change) {
+        ++sequence_;
+        if (followers_.empty())
+            return;  // Nobody to send it to; new followers start from a snapshot.
+        ++ops_;
+        batch_.push_back(static_cast<char>(change.kind));
+        detail::put_varint(batch_, change.from);
+        detail::put_varint(batch_, change.to);
+        if (change.kind != ListChange::Kind::Removed)
+            for (std::size_t row = change.from; row < change.to; ++row)
+                detail::put_row(batch_, *table_, row);
+        if (batch_.size() >= options_.max_batch_bytes)
+            flush();
+    }
+
+    void add_follower(detail::Socket socket) {
+        flush();  // The snapshot must not include ops that are still queued.
+        auto f = std::make_unique<Follower>();
+        f->conn = detail::FramedConnection(std::move(socket));
+        f->acked = sequence_;
+        const std::size_t at = f->conn.begin_frame();
+        std::string& out = f->conn.output();
+        out.push_back(static_cast<char>(detail::ReplicationFrame::Snapshot));
+        detail::put_fixed(out, detail::replication_layout<T>());
+        detail::put_fixed(out, sequence_);
+        detail::put_varint(out, table_->size());
+        for (std::size_t row = 0; row < table_->size(); ++row)
+            detail::put_row(out, *table_, row);
+        f->conn.end_frame(at);
+        f->snapshot_end = f->conn.written() + f->conn.pending_output();
+        if (f->conn.flush())
+            followers_.push_back(std::move(f));
+    }
+
+    static bool read_ack(Follower& f, std::string_view frame) {
+        std::uint8_t type = 0;
+        std::uint64_t seq = 0;
+        if (!detail::get_fixed(frame, type) || type != static_cast<std::uint8_t>(detail::ReplicationFrame::Ack) ||
+            !detail::get_fixed(frame, seq))
+            return false;
+        f.acked = std::max(f.acked, seq);
+        return true;
+    }
+
+    BeanTable<T>* table_;
+    Endpoint endpoint_;
+    ReplicationOptions options_;
+    detail::Socket listener_;
+    ListenerId listener_id_ = 0;
+    std::vector<std::unique_ptr<Follower>> followers_;
+    std::string batch_;
+    std::uint64_t ops_ = 0;
+    std::uint64_t sequence_ = 0;
+};
+
+/// Keeps a local `BeanTable` in step with a `ReplicationLeader`.
+///
+/// Changes are applied through the table's mutators, so the follower's own
+/// listeners see them as ordinary inserts, removals and replacements.  When
+/// the connection drops, `poll()` reconnects and the table is rebuilt from a
+/// fresh snapshot.
+template <Replicable T>
+class ReplicationFollower {
+public:
+    ReplicationFollower(BeanTable<T>& table, Endpoint endpoint) : table_(&table), endpoint_(std::move(endpoint)) {}
+
+    ReplicationFollower(const ReplicationFollower&) = delete;
+    ReplicationFollower& operator=(const ReplicationFollower&) = delete;
+
+    /// True once a snapshot has been applied on the current connection.
+    bool synchronized() const noexcept { return conn_.open() && synchronized_; }
+
+    /// The leader sequence number the table reflects.
+    std::uint64_t sequence() const noexcept { return sequence_; }
+
+    /// Connects if needed, applies whatever the leader has sent and
+    /// acknowledges it, waiting up to `timeout` for data.
+    void poll(std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) {
+        if (!conn_.open()) {
+            synchronized_ = false;
+            detail::Socket s = detail::Socket::connect(endpoint_);
+            if (!s) {
+                ::poll(nullptr, 0, detail::poll_timeout(timeout));  // Leader not up yet.
+                return;
+            }
+            conn_ = detail::FramedConnection(std::move(s));
+        }
+        pollfd fd{conn_.socket().fd(), static_cast<short>(POLLIN | (conn_.pending_output() ? POLLOUT : 0)), 0};
+        if (::poll(&fd, 1, detail::poll_timeout(timeout)) < 0 && errno != EINTR)
+            detail::throw_errno("poll");
+        if (fd.revents & (POLLIN | POLLHUP | POLLERR)) {
+            bool ok = conn_.receive();
+            std::size_t applied = 0;
+            conn_.for_each_frame([&](std::string_view frame) {
+                ok = ok && apply(frame);
+                applied += ok;
+            });
+            if (!ok) {
+                conn_.close();
+                return;
+            }
+            if (applied) {
+                // One acknowledgement covers everything applied in this poll.
+                std::string ack;
+                ack.push_back(static_cast<char>(detail::ReplicationFrame::Ack));
+                detail::put_fixed(ack, sequence_);
+                conn_.send(ack);
+            }
+        }
+        if (!conn_.flush())
+            conn_.close();
+    }
+
+private:
+    bool apply(std::string_view frame) {
+        std::uint8_t type = 0;
+        if (!detail::get_fixed(frame, type))
+            return false;
+        if (type == static_cast<std::uint8_t>(detail::ReplicationFrame::Snapshot))
+            return apply_snapshot(frame);
+        if (type == static_cast<std::uint8_t>(detail::ReplicationFrame::Batch) && synchronized_)
+            return apply_batch(frame);
+        return false;
+    }
+
+    bool apply_snapshot(std::string_view in) {
+        std::uint64_t layout = 0, seq = 0, rows = 0;
+        if (!detail::get_fixed(in, layout) || layout != detail::replication_layout<T>() ||
+            !detail::get_fixed(in, seq) || !detail::get_varint(in, rows))
+            return false;
+        table_->clear();
+        table_->reserve(static_cast<std::size_t>(std::min<std::uint64_t>(rows, in.size())));
+        for (std::uint64_t i = 0; i < rows; ++i) {
+            T bean{};
+            if (!detail::get_row(in, bean))
+                return false;
+            table_->push_back(std::move(bean));
+        }
+        sequence_ = seq;
+        synchronized_ = true;
+        return true;
+    }
+
+    bool apply_batch(std::string_view in) {
+        std::uint64_t seq = 0, ops = 0;
+        if (!detail::get_fixed(in, seq) || !detail::get_varint(in, ops))
+            return false;
+        for (std::uint64_t i = 0; i < ops; ++i) {
+            std::uint8_t kind = 0;
+            std::uint64_t from = 0, to = 0;
+            if (!detail::get_fixed(in, kind) || !detail::get_varint(in, from) || !detail::get_varint(in, to) ||
+                from > to || from > table_->size())
+                return false;
+            switch (static_cast<ListChange::Kind>(kind)) {
+            case ListChange::Kind::Inserted:
+                for (std::uint64_t row = from; row < to; ++row) {
+                    T bean{};
+                    if (!detail::get_row(in, bean))
+                        return false;
+                    table_->insert(static_cast<std::size_t>(row), bean);
+                }
+                break;
+            case ListChange::Kind::Removed:
+                if (to > table_->size())
+                    return false;
+                table_->erase(static_cast<std::size_t>(from), static_cast<std::size_t>(to));
+                break;
+            case ListChange::Kind::Replaced:
+                if (to > table_->size())
+                    return false;
+                for (std::uint64_t row = from; row < to; ++row) {
+                    T bean{};
+                    if (!detail::get_row(in, bean))
+                        return false;
+                    table_->assign(static_cast<std::size_t>(row), bean);
+                }
+                break;
+            default:
+                return false;
+            }
+        }
+        sequence_ = seq;
+        return true;
+    }
+
+    BeanTable<T>* table_;
+    Endpoint endpoint_;
+    detail::FramedConnection conn_;
+    std::uint64_t sequence_ = 0;
+    bool synchronized_ = false;
+};
+
+}  // namespace beans
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "bean_tree.hpp"
+#include "detail/listeners.hpp"
+#include "detail/vector.hpp"
+#include "function.hpp"
+
+namespace beans {
+
+/// The two legs of a routed event's route: tunnelling from the root down to
+/// the source, then bubbling from the source back up to the root.
+enum class RoutePhase : std::uint8_t { Tunnel, Bubble };
+
+/// Handle for an event type defined on an `EventRouter`; `Args` is the
+/// payload handlers receive.
+template <class Args>
+struct RoutedEvent {
+    std::uint8_t id;
+};
+
+/// Where a routed event is on its route.  A handler sets `handled` to stop
+/// the event: no further handler is called, in either phase.
+struct RouteInfo {
+    NodeId source;
+    NodeId current;
+    RoutePhase phase;
+    bool handled = false;
+};
+
+/// Routes events through a `BeanTree`, as WPF routed events do: an event
+/// raised at a node first tunnels from the root down to it, then bubbles
+/// back up, calling the handlers registered on each node along the way.
+///
+/// Each node carries a mask of the event types handled on it and a route
+/// mask, the union of the masks of the node and its ancestors.  Raising an
+/// event where no handler exists on the route costs one mask test, and the
+/// walk up the tree stops at the first ancestor above which no handler
+/// exists, instead of climbing to the root.  Masks are updated incrementally
+/// when handlers are added or removed and when the tree changes.  An
+/// `EventRouter` defines at most 64 event types.
+///
+/// Handlers may raise events and add or remove handlers.  The router must
+/// not outlive the tree.
+template <class T>
+class EventRouter {
+public:
+    static constexpr std::size_t max_events = 64;
+
+    explicit EventRouter(BeanTree<T>& tree) : tree_(tree) {
+        own_.resize(tree.capacity());
+        route_.resize(tree.capacity());
+        first_.resize(tree.capacity());
+        for (std::uint32_t& h : first_)
+            h = no_handler;
+        structure_ = tree.subscribe([this](const BeanTree<T>&, const TreeChange& change) { on_change(change); });
+    }
+
+    EventRouter(const EventRouter&) = delete;
+    EventRouter& operator=(const EventRouter&) = delete;
+
+    ~EventRouter() { tree_.unsubscribe(structure_); }
+
+    /// Defines a new event type; throws `std::length_error` past `max_events`.
+    template <class Args>
+    RoutedEvent<Args> define() {
+        if (events_ == max_events)
+            throw std::length_error("EventRouter: too many event types");
+        return {static_cast<std::uint8_t>(events_++)};
+    }
+
+    /// Calls `handler(RouteInfo&, Args&)` when `event` passes `node` in
+    /// `phase`.  Handlers on one node run in registration order.
+    template <class Args, class F>
+    ListenerId add_handler(NodeId node, RoutedEvent<Args> event, RoutePhase phase, F handler) {
+        auto slot = std::make_unique<Slot>();
+        slot->id = ++last_id_;
+        slot->node = node;
+        slot->event = event.id;
+        slot->phase = phase;
+        slot->fn = [f = std::move(handler)](RouteInfo& info, void* args) mutable {
+            f(info, *static_cast<Args*>(args));
+        };
+        std::uint32_t index;
+        if (!free_.empty()) {
+            index = free_.back();
+            free_.pop_back();
+            slots_[index] = std::move(slot);
+        } else {
+            index = static_cast<std::uint32_t>(slots_.size());
+            slots_.emplace_back(std::move(slot));
+        }
+        std::uint32_t* link = &first_[node];
+        while (*link != no_handler)
+            link = &slots_[*link]->next;
+        *link = index;
+        own_[node] |= bit(event.id);
+        refresh(node);
+        return slots_[index]->id;
+    }
+
+    /// Removes the handler registered under `id`; returns false if unknown.
+    bool remove_handler(ListenerId id) {
+        for (std::uint32_t i = 0; i < slots_.size(); ++i) {
+            if (slots_[i] && slots_[i]->id == id && !slots_[i]->removed) {
+                unlink(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Whether some node from `node` up to its root handles `event`.
+    template <class Args>
+    bool has_route(NodeId node, RoutedEvent<Args> event) const noexcept {
+        return route_[node] & bit(event.id);
+    }
+
+    /// Raises `event` at `source`; returns true if a handler marked it
+    /// handled.
+    template <class Args>
+    bool raise(NodeId source, RoutedEvent<Args> event, Args& args) {
+        const std::uint64_t mask = bit(event.id);
+        if (!(route_[source] & mask))
+            return false;
+        // Nodes on the route with handlers for the event, source first.  The
+        // path is a slice of a shared stack so handlers can raise events.
+        const std::size_t base = path_.size();
+        for (NodeId n = source; n != no_node && (route_[n] & mask); n = tree_.parent(n))
+            if (own_[n] & mask)
+                path_.emplace_back(n);
+        const std::size_t end = path_.size();
+
+        RouteInfo info{source, source, RoutePhase::Tunnel};
+        ++depth_;
+        try {
+            for (std::size_t i = end; i > base && !info.handled; --i)
+                invoke(path_[i - 1], event.id, info, &args);
+            info.phase = RoutePhase::Bubble;
+            for (std::size_t i = base; i < end && !info.handled; ++i)
+                invoke(path_[i], event.id, info, &args);
+        } catch (...) {
+            finish(base);
+            throw;
+        }
+        finish(base);
+        return info.handled;
+    }
+
+    template <class Args>
+    bool raise(NodeId source, RoutedEvent<Args> event, Args&& args) {
+        return raise(source, event, args);
+    }
+
+private:
+    static constexpr std::uint32_t no_handler = ~std::uint32_t{0};
+
+    struct Slot {
+        ListenerId id = 0;
+        NodeId node = no_node;
+        std::uint8_t event = 0;
+        RoutePhase phase = RoutePhase::Bubble;
+        bool removed = false;
+        std::uint32_t next = no_handler;
+        Function<void(RouteInfo&, void*)> fn;
+    };
+
+    static constexpr std::uint64_t bit(std::uint8_t event) noexcept { return std::uint64_t{1} << event; }
+
+    void invoke(NodeId node, std::uint8_t event, RouteInfo& info, void* args) {
+        info.current = node;
+        for (std::uint32_t i = first_[node]; i != no_handler && !info.handled;) {
+            // Read the link first: the handler may remove itself.
+            Slot& slot = *slots_[i];
+            i = slot.next;
+            if (!slot.removed && slot.event == event && slot.phase == info.phase)
+                slot.fn(info, args);
+        }
+    }
+
+    void finish(std::size_t base) {
+        path_.resize(base);
+        if (--depth_ == 0) {
+            for (std::uint32_t i : garbage_) {
+                slots_[i].reset();
+                free_.emplace_back(i);
+            }
+            garbage_.clear();
+        }
+    }
+
+    /// Takes slot `i` off its node's list and updates the masks.
+    void unlink(std::uint32_t i) {
+        const NodeId node = slots_[i]->node;
+        std::uint32_t* link = &first_[node];
+        while (*link != i)
+            link = &slots_[*link]->next;
+        *link = slots_[i]->next;
+        drop(i);
+        std::uint64_t own = 0;
+        for (std::uint32_t h = first_[node]; h != no_handler; h = slots_[h]->next)
+            own |= bit(slots_[h]->event);
+        if (own != own_[node]) {
+            own_[node] = own;
+            refresh(node);
+        }
+    }
+
+    /// Frees slot `i`, or marks it for freeing once no event is being
+    /// dispatched, as a handler may be running or iterating past it.
+    void drop(std::uint32_t i) {
+        slots_[i]->removed = true;
+        if (depth_ == 0) {
+            slots_[i].reset();
+            free_.emplace_back(i);
+        } else {
+            garbage_.emplace_back(i);
+        }
+    }
+
+    /// Recomputes route masks from `node` down, skipping subtrees whose mask
+    /// is unchanged.
+    void refresh(NodeId node) {
+        stack_.clear();
+        stack_.emplace_back(node);
+        while (!stack_.empty()) {
+            const NodeId n = stack_.back();
+            stack_.pop_back();
+            const NodeId parent = tree_.parent(n);
+            const std::uint64_t route = own_[n] | (parent == no_node ? 0 : route_[parent]);
+            if (route == route_[n])
+                continue;
+            route_[n] = route;
+            tree_.for_each_child(n, [&](NodeId c) { stack_.emplace_back(c); });
+        }
+    }
+
+    void on_change(const TreeChange& change) {
+        const NodeId node = change.node;
+        switch (change.kind) {
+        case TreeChange::Kind::Added:
+            // New ids are handed out in order; emplace_back grows geometrically.
+            while (own_.size() <= node) {
+                own_.emplace_back();
+                route_.emplace_back();
+                first_.emplace_back();
+            }
+            own_[node] = 0;
+            first_[node] = no_handler;
+            route_[node] = change.parent == no_node ? 0 : route_[change.parent];
+            break;
+        case TreeChange::Kind::Moved:
+            refresh(node);
+            break;
+        case TreeChange::Kind::Removed:
+            // The subtree is still attached: drop the handlers on it.
+            stack_.clear();
+            stack_.emplace_back(node);
+            while (!stack_.empty()) {
+                const NodeId n = stack_.back();
+                stack_.pop_back();
+                for (std::uint32_t h = first_[n]; h != no_handler;) {
+                    const std::uint32_t next = slots_[h]->next;
+                    drop(h);
+                    h = next;
+                }
+                first_[n] = no_handler;
+                own_[n] = route_[n] = 0;
+                tree_.for_each_child(n, [&](NodeId c) { stack_.emplace_back(c); });
+            }
+            break;
+        }
+    }
+
+    BeanTree<T>& tree_;
+    detail::Vector<std::uint64_t> own_;    // Events handled on the node.
+    detail::Vector<std::uint64_t> route_;  // own_ of the node and its ancestors.
+    detail::Vector<std::uint32_t> first_;  // Head of the node's handler list.
+    detail::Vector<std::unique_ptr<Slot>> slots_;
+    detail::Vector<std::uint32_t> free_;
+    detail::Vector<std::uint32_t> garbage_;
+    detail::Vector<NodeId> path_;
+    detail::Vector<NodeId> stack_;
+    std::size_t events_ = 0;
+    std::size_t depth_ = 0;
+    ListenerId last_id_ = 0;
+    ListenerId structure_ = 0;
+};
+
+}  // namespace beans
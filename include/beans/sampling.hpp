@@ -0,0 +1,232 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace beans::sampling {
+
+/// Context captured for one setter call that exceeded the sampler threshold.
+///
+/// Only static strings and integers are stored (no stack traces), so recording
+/// a sample never allocates.  `bean_type` and `property` must therefore refer
+/// to storage that outlives the sampler, which string literals do.
+struct SetterSample {
+    std::string_view bean_type;
+    std::string_view property;
+    std::uint32_t listener_count = 0;
+    std::uint64_t thread = 0;
+    std::chrono::nanoseconds elapsed{0};
+    std::chrono::steady_clock::time_point when{};
+    std::uint64_t sequence = 0;
+};
+
+/// Fixed-capacity ring buffer of slow setter samples.
+///
+/// `record()` is lock-free and may be called from any number of threads; when
+/// the buffer is full the oldest samples are overwritten.  `drain()` is meant
+/// for a single reader (a monitoring thread or a test) and must not be called
+/// concurrently with itself.
+class SlowSetterSampler {
+public:
+    explicit SlowSetterSampler(std::chrono::nanoseconds threshold, std::size_t capacity = 1024)
+        : threshold_(threshold.count()), mask_(round_up_pow2(capacity) - 1),
+          slots_(std::make_unique<Slot[]>(mask_ + 1)) {}
+
+    SlowSetterSampler(const SlowSetterSampler&) = delete;
+    SlowSetterSampler& operator=(const SlowSetterSampler&) = delete;
+
+    std::chrono::nanoseconds threshold() const noexcept {
+        return std::chrono::nanoseconds(threshold_.load(std::memory_order_relaxed));
+    }
+    void set_threshold(std::chrono::nanoseconds threshold) noexcept {
+        threshold_.store(threshold.count(), std::memory_order_relaxed);
+    }
+
+    std::size_t capacity() const noexcept { return mask_ + 1; }
+
+    /// Total number of samples recorded since construction.
+    std::uint64_t recorded() const noexcept { return head_.load(std::memory_order_relaxed); }
+
+    /// Number of samples overwritten before `drain()` could read them.
+    std::uint64_t lost() const noexcept { return lost_; }
+
+    /// Records `sample` if its elapsed time reaches the threshold.
+    void offer(const SetterSample& sample) noexcept {
+        if (sample.elapsed.count() >= threshold_.load(std::memory_order_relaxed))
+            record(sample);
+    }
+
+    /// Unconditionally records `sample`, overwriting the oldest one if full.
+    void record(const SetterSample& sample) noexcept {
+        const std::uint64_t index = head_.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots_[index & mask_];
+
+        // Claim the slot with an odd sequence number.  A writer that stalled for
+        // a full lap finds a newer claim there and drops its sample instead of
+        // clobbering the newer one.
+        const std::uint64_t writing = 2 * index + 1;
+        std::uint64_t seen = slot.seq.load(std::memory_order_relaxed);
+        do {
+            if (seen >= writing)
+                return;
+        } while (!slot.seq.compare_exchange_weak(seen, writing, std::memory_order_relaxed));
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.bean_data.store(sample.bean_type.data(), std::memory_order_relaxed);
+        slot.bean_size.store(sample.bean_type.size(), std::memory_order_relaxed);
+        slot.property_data.store(sample.property.data(), std::memory_order_relaxed);
+        slot.property_size.store(sample.property.size(), std::memory_order_relaxed);
+        slot.listener_count.store(sample.listener_count, std::memory_order_relaxed);
+        slot.thread.store(sample.thread, std::memory_order_relaxed);
+        slot.elapsed.store(sample.elapsed.count(), std::memory_order_relaxed);
+        slot.when.store(sample.when.time_since_epoch().count(), std::memory_order_relaxed);
+
+        // Publish only if the claim still stands: a faster writer may have
+        // re-claimed the slot meanwhile, and a plain store would move its
+        // sequence backwards.  Our sample lost the race; drop it.
+        std::uint64_t claimed = writing;
+        slot.seq.compare_exchange_strong(claimed, writing + 1, std::memory_order_release,
+                                         std::memory_order_relaxed);
+    }
+
+    /// Appends every sample published since the previous call to `out`, oldest
+    /// first, and returns how many were appended.  Samples still being written
+    /// are left for the next call.
+    std::size_t drain(std::vector<SetterSample>& out) {
+        const std::uint64_t head = head_.load(std::memory_order_acquire);
+        if (head - tail_ > capacity()) {
+            lost_ += head - tail_ - capacity();
+            tail_ = head - capacity();
+        }
+
+        std::size_t appended = 0;
+        for (; tail_ != head; ++tail_) {
+            const Slot& slot = slots_[tail_ & mask_];
+            const std::uint64_t expected = 2 * tail_ + 2;
+            const std::uint64_t before = slot.seq.load(std::memory_order_acquire);
+            if (before < expected)
+                break;  // Not published yet; pick it up next time.
+            if (before > expected) {
+                ++lost_;  // Overwritten by a later lap.
+                continue;
+            }
+
+            SetterSample sample;
+            sample.bean_type = {slot.bean_data.load(std::memory_order_relaxed),
+                                slot.bean_size.load(std::memory_order_relaxed)};
+            sample.property = {slot.property_data.load(std::memory_order_relaxed),
+                               slot.property_size.load(std::memory_order_relaxed)};
+            sample.listener_count = slot.listener_count.load(std::memory_order_relaxed);
+            sample.thread = slot.thread.load(std::memory_order_relaxed);
+            sample.elapsed = std::chrono::nanoseconds(slot.elapsed.load(std::memory_order_relaxed));
+            sample.when = std::chrono::steady_clock::time_point(
+                std::chrono::steady_clock::duration(slot.when.load(std::memory_order_relaxed)));
+            sample.sequence = tail_;
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != expected) {
+                ++lost_;
+                continue;
+            }
+            out.push_back(sample);
+            ++appended;
+        }
+        return appended;
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> seq{0};
+        std::atomic<const char*> bean_data{nullptr};
+        std::atomic<std::size_t> bean_size{0};
+        std::atomic<const char*> property_data{nullptr};
+        std::atomic<std::size_t> property_size{0};
+        std::atomic<std::uint32_t> listener_count{0};
+        std::atomic<std::uint64_t> thread{0};
+        std::atomic<std::int64_t> elapsed{0};
+        std::atomic<std::int64_t> when{0};
+    };
+
+    static std::size_t round_up_pow2(std::size_t n) noexcept {
+        std::size_t p = 1;
+        while (p < n)
+            p <<= 1;
+        return p;
+    }
+
+    std::atomic<std::int64_t> threshold_;
+    const std::size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<std::uint64_t> head_{0};
+    alignas(64) std::uint64_t tail_ = 0;
+    std::uint64_t lost_ = 0;
+};
+
+namespace detail {
+inline std::atomic<SlowSetterSampler*>& installed_sampler() noexcept {
+    static std::atomic<SlowSetterSampler*> sampler{nullptr};
+    return sampler;
+}
+}  // namespace detail
+
+/// Installs `sampler` process-wide; pass nullptr to turn sampling off.  The
+/// caller keeps ownership and must uninstall it before destroying it.
+inline void install(SlowSetterSampler* sampler) noexcept {
+    detail::installed_sampler().store(sampler, std::memory_order_release);
+}
+
+/// Returns the installed sampler, or nullptr when sampling is off.
+inline SlowSetterSampler* installed() noexcept {
+    return detail::installed_sampler().load(std::memory_order_acquire);
+}
+
+/// Times a setter from construction to destruction and offers the result to
+/// the installed sampler.  Costs a single atomic load when sampling is off.
+class ScopedSetter {
+public:
+    ScopedSetter(std::string_view bean_type, std::string_view property,
+                 std::size_t listener_count) noexcept
+        : sampler_(installed()) {
+        if (sampler_) [[unlikely]] {
+            bean_type_ = bean_type;
+            property_ = property;
+            listener_count_ = static_cast<std::uint32_t>(listener_count);
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ScopedSetter(const ScopedSetter&) = delete;
+    ScopedSetter& operator=(const ScopedSetter&) = delete;
+
+    ~ScopedSetter() {
+        if (!sampler_) [[likely]]
+            return;
+        const auto now = std::chrono::steady_clock::now();
+        SetterSample sample;
+        sample.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_);
+        if (sample.elapsed < sampler_->threshold())
+            return;
+        sample.bean_type = bean_type_;
+        sample.property = property_;
+        sample.listener_count = listener_count_;
+        sample.thread = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        sample.when = now;
+        sampler_->record(sample);
+    }
+
+private:
+    SlowSetterSampler* sampler_;
+    std::string_view bean_type_;
+    std::string_view property_;
+    std::uint32_t listener_count_ = 0;
+    std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace beans::sampling
@@ -0,0 +1,457 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include "descriptor.hpp"
+#include "fixed_string.hpp"
+#include "reflect.hpp"
+
+namespace beans {
+
+namespace detail {
+
+template <class T, class Seq = std::make_index_sequence<field_count_v<T>>>
+struct shareable_fields;
+template <class T, std::size_t... I>
+struct shareable_fields<T, std::index_sequence<I...>>
+    : std::bool_constant<(std::is_trivially_copyable_v<field_t<T, I>> && ...)> {};
+
+/// Fingerprint of a bean type's layout; a reader refuses a segment written
+/// for a different one.
+template <class T>
+constexpr std::uint64_t layout_hash() noexcept {
+    const BeanDescriptor& d = descriptor_of<T>();
+    std::uint64_t h = name_hash(d.name);
+    auto mix = [&h](std::uint64_t v) { h = (h ^ v) * 0x100000001b3ull; };
+    for (const FieldDescriptor& f : d.fields) {
+        mix(f.hash);
+        mix(static_cast<std::uint64_t>(f.kind));
+        mix(f.size);
+        mix(f.align);
+    }
+    return h;
+}
+
+struct SharedTableHeader {
+    static constexpr std::uint64_t magic_value = 0x31454c4241544e42ull;  // "BNTABLE1"
+
+    std::uint64_t magic;
+    std::uint64_t layout;
+    std::uint64_t capacity;
+    std::uint64_t bytes;
+    std::atomic<std::uint64_t> size;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free &&
+                  std::atomic<std::uint32_t>::is_always_lock_free,
+              "shared tables need address-free atomics");
+
+/// Where each part of a shared table lives inside its segment.
+template <class T>
+struct SharedTableLayout {
+    static constexpr std::size_t n = field_count_v<T>;
+    static constexpr std::size_t line = 64;
+
+    std::size_t sequences = 0;
+    std::size_t columns[n > 0 ? n : 1] = {};
+    std::size_t bytes = 0;
+
+    static constexpr std::size_t round_up(std::size_t v) noexcept { return (v + line - 1) / line * line; }
+
+    explicit constexpr SharedTableLayout(std::size_t capacity) noexcept {
+        sequences = round_up(sizeof(SharedTableHeader));
+        std::size_t at = round_up(sequences + capacity * sizeof(std::uint32_t));
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((columns[I] = at, at = round_up(at + capacity * sizeof(field_t<T, I>))), ...);
+        }(std::make_index_sequence<n>{});
+        bytes = at;
+    }
+};
+
+/// Relaxed element-wise copies: scalar fields go through atomic_ref so
+/// concurrent readers and the writer never race in the C++ sense; other
+/// fields are copied bytewise and validated by the row's sequence number.
+template <class U>
+inline constexpr bool word_sized = std::is_scalar_v<U> && std::atomic_ref<U>::is_always_lock_free;
+
+template <class U>
+void shared_store(U* at, const U& value) noexcept {
+    if constexpr (word_sized<U>)
+        std::atomic_ref<U>(*at).store(value, std::memory_order_relaxed);
+    else
+        std::memcpy(static_cast<void*>(at), &value, sizeof(U));
+}
+
+template <class U>
+U shared_load(const U* at) noexcept {
+    if constexpr (word_sized<U>) {
+        return std::atomic_ref<U>(*const_cast<U*>(at)).load(std::memory_order_relaxed);
+    } else {
+        U value;
+        std::memcpy(&value, static_cast<const void*>(at), sizeof(U));
+        return value;
+    }
+}
+
+/// An mmap'ed POSIX shared memory segment.
+class SharedSegment {
+public:
+    SharedSegment() noexcept = default;
+
+    SharedSegment(SharedSegment&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)), bytes_(std::exchange(other.bytes_, 0)) {}
+
+    SharedSegment& operator=(SharedSegment&& other) noexcept {
+        if (this != &other) {
+            reset();
+            data_ = std::exchange(other.data_, nullptr);
+            bytes_ = std::exchange(other.bytes_, 0);
+        }
+        return *this;
+    }
+
+    ~SharedSegment() { reset(); }
+
+    static SharedSegment create(const std::string& name, std::size_t bytes) {
+        ::shm_unlink(name.c_str());  // A previous writer may have crashed.
+        const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            const int err = errno;
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw std::system_error(err, std::generic_category(), "ftruncate " + name);
+        }
+        return map(fd, name, bytes, PROT_READ | PROT_WRITE);
+    }
+
+    static SharedSegment open(const std::string& name) {
+        const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            const int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "fstat " + name);
+        }
+        return map(fd, name, static_cast<std::size_t>(st.st_size), PROT_READ);
+    }
+
+    void* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return bytes_; }
+
+private:
+    static SharedSegment map(int fd, const std::string& name, std::size_t bytes, int prot) {
+        void* p = ::mmap(nullptr, bytes, prot, MAP_SHARED, fd, 0);
+        const int err = errno;
+        ::close(fd);
+        if (p == MAP_FAILED)
+            throw std::system_error(err, std::generic_category(), "mmap " + name);
+        SharedSegment segment;
+        segment.data_ = p;
+        segment.bytes_ = bytes;
+        return segment;
+    }
+
+    void reset() noexcept {
+        if (data_)
+            ::munmap(data_, bytes_);
+        data_ = nullptr;
+        bytes_ = 0;
+    }
+
+    void* data_ = nullptr;
+    std::size_t bytes_ = 0;
+};
+
+}  // namespace detail
+
+template <class T>
+concept Shareable = Reflectable<T> && std::is_default_constructible_v<T> &&
+                    detail::shareable_fields<T>::value;
+
+/// Columns of a `SharedBeanTable` segment, shared by the writer and readers.
+template <Shareable T>
+class SharedTableView {
+public:
+    using bean_type = T;
+    static constexpr std::size_t column_count = field_count_v<T>;
+
+    std::size_t size() const noexcept { return header()->size.load(std::memory_order_acquire); }
+    bool empty() const noexcept { return size() == 0; }
+    std::size_t capacity() const noexcept { return header()->capacity; }
+
+protected:
+    using Layout = detail::SharedTableLayout<T>;
+
+    SharedTableView(detail::SharedSegment segment, std::size_t capacity)
+        : segment_(std::move(segment)), layout_(capacity) {}
+
+    detail::SharedTableHeader* header() const noexcept {
+        return static_cast<detail::SharedTableHeader*>(segment_.data());
+    }
+
+    std::atomic<std::uint32_t>* sequence(std::size_t row) const noexcept {
+        auto* base = static_cast<std::byte*>(segment_.data()) + layout_.sequences;
+        return reinterpret_cast<std::atomic<std::uint32_t>*>(base) + row;
+    }
+
+    template <std::size_t I>
+    field_t<T, I>* column() const noexcept {
+        auto* base = static_cast<std::byte*>(segment_.data()) + layout_.columns[I];
+        return reinterpret_cast<field_t<T, I>*>(base);
+    }
+
+    static constexpr auto indices() noexcept { return std::make_index_sequence<column_count>{}; }
+
+    detail::SharedSegment segment_;
+    Layout layout_;
+};
+
+/// The writing side of a bean table in POSIX shared memory.  One process
+/// writes; any number of processes read through `SharedBeanTableReader`
+/// without locks.
+///
+/// Each row has a sequence number (a seqlock): the writer makes it odd while
+/// it updates the row and even afterwards, and readers retry when they see
+/// it change underneath them.  Rows are appended or updated in place; the
+/// capacity is fixed when the segment is created.  Fields must be trivially
+/// copyable (numbers, enums, small structs of those; not `std::string`),
+/// because the segment is mapped at different addresses in each process.
+///
+/// Destroying the writer removes the segment's name; readers that already
+/// mapped it keep working.
+template <Shareable T>
+class SharedBeanTable : public SharedTableView<T> {
+    using Base = SharedTableView<T>;
+
+public:
+    /// Creates the segment `name` (e.g. "/quotes"), replacing any stale one.
+    SharedBeanTable(std::string name, std::size_t capacity)
+        : Base(detail::SharedSegment::create(name, typename Base::Layout(capacity).bytes), capacity),
+          name_(std::move(name)) {
+        auto* h = this->header();
+        h->layout = detail::layout_hash<T>();
+        h->capacity = capacity;
+        h->bytes = this->layout_.bytes;
+        h->size.store(0, std::memory_order_relaxed);
+        // Written last: readers check it before trusting anything else.
+        std::atomic_ref<std::uint64_t>(h->magic).store(detail::SharedTableHeader::magic_value,
+                                                       std::memory_order_release);
+    }
+
+    SharedBeanTable(const SharedBeanTable&) = delete;
+    SharedBeanTable& operator=(const SharedBeanTable&) = delete;
+
+    ~SharedBeanTable() { ::shm_unlink(name_.c_str()); }
+
+    const std::string& name() const noexcept { return name_; }
+
+    /// Appends `bean`; throws `std::length_error` when the table is full.
+    std::size_t push_back(const T& bean) {
+        const std::size_t row = this->header()->size.load(std::memory_order_relaxed);
+        if (row == this->capacity())
+            throw std::length_error("shared bean table '" + name_ + "' is full");
+        write(row, [&] { store_all(row, bean); });
+        this->header()->size.store(row + 1, std::memory_order_release);
+        return row;
+    }
+
+    /// Overwrites row `row` with `bean`.
+    void assign(std::size_t row, const T& bean) noexcept {
+        write(row, [&] { store_all(row, bean); });
+    }
+
+    /// Overwrites field `I` of row `row`.
+    template <std::size_t I>
+    void set(std::size_t row, const field_t<T, I>& value) noexcept {
+        write(row, [&] { detail::shared_store(this->template column<I>() + row, value); });
+    }
+    template <FixedString Name>
+    void set(std::size_t row, const field_t<T, field_index_v<T, Name>>& value) noexcept {
+        set<field_index_v<T, Name>>(row, value);
+    }
+
+    /// Drops every row.  Readers see the new size on their next call.
+    void clear() noexcept { this->header()->size.store(0, std::memory_order_release); }
+
+private:
+    template <class F>
+    void write(std::size_t row, F&& update) noexcept {
+        auto* seq = this->sequence(row);
+        const std::uint32_t s = seq->load(std::memory_order_relaxed);
+        seq->store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        update();
+        seq->store(s + 2, std::memory_order_release);
+    }
+
+    void store_all(std::size_t row, const T& bean) noexcept {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (detail::shared_store(this->template column<I>() + row, beans::get<I>(bean)), ...);
+        }(this->indices());
+    }
+
+    std::string name_;
+};
+
+/// The reading side of a `SharedBeanTable`, usually in another process.
+/// Reads never block the writer; a read that overlaps a write to the same
+/// row is retried.  A row that stays mid-write for `stall_timeout` belongs to
+/// a writer that died while updating it, and reading it throws.
+template <Shareable T>
+class SharedBeanTableReader : public SharedTableView<T> {
+    using Base = SharedTableView<T>;
+
+public:
+    static constexpr std::chrono::milliseconds stall_timeout{1000};
+
+    /// Maps the segment `name`.  Throws `std::system_error` if it does not
+    /// exist and `std::runtime_error` if it holds a different bean type.
+    explicit SharedBeanTableReader(const std::string& name) : SharedBeanTableReader(map(name)) {}
+
+    /// Copies row `row` into `bean`; returns false instead of waiting if the
+    /// writer is updating that row, or if `row` is past the capacity.  Only
+    /// fields that differ are written, so a nullable field left at its
+    /// default stays null and a sparse one takes no entry.
+    bool try_read(std::size_t row, T& bean) const noexcept(all_addressable) {
+        if (row >= this->capacity())
+            return false;
+        const auto* seq = this->sequence(row);
+        const std::uint32_t before = seq->load(std::memory_order_acquire);
+        if (before & 1)
+            return false;
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (store<I>(bean, detail::shared_load(this->template column<I>() + row)), ...);
+        }(this->indices());
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return seq->load(std::memory_order_relaxed) == before;
+    }
+
+    /// A consistent copy of row `row`.  Throws `std::out_of_range` if `row`
+    /// is past the capacity and `std::runtime_error` if the row is stalled.
+    T read(std::size_t row) const {
+        check(row);
+        T bean{};
+        Stall stall;
+        while (!try_read(row, bean))
+            backoff(this->sequence(row), stall);
+        return bean;
+    }
+
+    /// A consistent copy of field `I` of row `row`; throws as `read(row)`.
+    template <std::size_t I>
+    field_t<T, I> read(std::size_t row) const {
+        check(row);
+        const auto* seq = this->sequence(row);
+        Stall stall;
+        for (;;) {
+            const std::uint32_t before = seq->load(std::memory_order_acquire);
+            if (!(before & 1)) {
+                field_t<T, I> value = detail::shared_load(this->template column<I>() + row);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (seq->load(std::memory_order_relaxed) == before)
+                    return value;
+            }
+            backoff(seq, stall);
+        }
+    }
+    template <FixedString Name>
+    auto read(std::size_t row) const {
+        return read<field_index_v<T, Name>>(row);
+    }
+
+private:
+    struct Mapped {
+        detail::SharedSegment segment;
+        std::size_t capacity;
+    };
+
+    explicit SharedBeanTableReader(Mapped mapped)
+        : Base(std::move(mapped.segment), mapped.capacity) {}
+
+    // Storing a sparse field can allocate.
+    static constexpr bool all_addressable = []<std::size_t... I>(std::index_sequence<I...>) {
+        return (field_addressable_v<T, I> && ...);
+    }(Base::indices());
+
+    template <std::size_t I>
+    static void store(T& bean, const field_t<T, I>& value) noexcept(field_addressable_v<T, I>) {
+        if constexpr (std::equality_comparable<field_t<T, I>>) {
+            if (beans::get<I>(std::as_const(bean)) == value)
+                return;
+        }
+        beans::get<I>(bean) = value;
+    }
+
+    static Mapped map(const std::string& name) {
+        detail::SharedSegment segment = detail::SharedSegment::open(name);
+        const auto* h = static_cast<const detail::SharedTableHeader*>(segment.data());
+        if (segment.size() < sizeof(detail::SharedTableHeader) ||
+            std::atomic_ref<std::uint64_t>(const_cast<std::uint64_t&>(h->magic))
+                    .load(std::memory_order_acquire) !=
+                detail::SharedTableHeader::magic_value)
+            throw std::runtime_error("'" + name + "' is not a shared bean table");
+        if (h->layout != detail::layout_hash<T>())
+            throw std::runtime_error("'" + name + "' holds a different bean type");
+        const std::size_t capacity = h->capacity;
+        if (h->bytes != typename Base::Layout(capacity).bytes || segment.size() < h->bytes)
+            throw std::runtime_error("'" + name + "' has an unexpected size");
+        return {std::move(segment), capacity};
+    }
+
+    /// How long a row has been seen stuck at one odd sequence number.
+    struct Stall {
+        std::uint32_t sequence = 0;
+        std::uint32_t spins = 0;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    void check(std::size_t row) const {
+        if (row >= this->capacity())
+            throw std::out_of_range("shared bean table row " + std::to_string(row) + " is out of range");
+    }
+
+    /// Pauses before a retry.  The clock is read only once a row has been
+    /// mid-write for a while, so the common retry costs a pause.
+    static void backoff(const std::atomic<std::uint32_t>* seq, Stall& stall) {
+        const std::uint32_t s = seq->load(std::memory_order_relaxed);
+        if (!(s & 1) || s != stall.sequence) {
+            stall.sequence = s;
+            stall.spins = 0;
+        } else if (++stall.spins % 1024 == 0) {
+            const auto now = std::chrono::steady_clock::now();
+            if (stall.spins == 1024)
+                stall.since = now;
+            else if (now - stall.since >= stall_timeout)
+                throw std::runtime_error("shared bean table row is stuck mid-write; its writer died");
+        }
+        spin();
+    }
+
+    static void spin() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+};
+
+}  // namespace beans
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+#include "sampling.hpp"
+
+namespace beans {
+
+template <class Signature, class... Slots>
+class StaticSignal;
+
+/// A signal whose slots are fixed by its type.  `emit()` calls each slot
+/// directly, in order, so the calls can be inlined; there is no type erasure,
+/// no allocation and no way to connect further slots at runtime.  Slots may
+/// carry state, which is stored inside the signal.
+///
+///     StaticSignal<void(int), Log, Forward> changed{Log{}, Forward{&sink}};
+///     changed.emit(42);
+template <class... Args, class... Slots>
+class StaticSignal<void(Args...), Slots...> {
+public:
+    static constexpr std::size_t slot_count = sizeof...(Slots);
+
+    constexpr StaticSignal() = default;
+    constexpr explicit StaticSignal(Slots... slots)
+        requires(slot_count > 0)
+        : slots_(std::move(slots)...) {}
+
+    constexpr void emit(const Args&... args) {
+        std::apply([&](auto&... slot) { (slot(args...), ...); }, slots_);
+    }
+
+    template <std::size_t I>
+    constexpr auto& slot() noexcept {
+        return std::get<I>(slots_);
+    }
+    template <class S>
+    constexpr S& slot() noexcept {
+        return std::get<S>(slots_);
+    }
+
+private:
+    [[no_unique_address]] std::tuple<Slots...> slots_;
+};
+
+/// Counterpart of `Property` for fixed topologies: the listeners are part of
+/// the type and are called as `slot(old_value, new_value)` without indirection.
+template <class T, class... Slots>
+class StaticProperty {
+public:
+    using value_type = T;
+    static constexpr std::size_t listener_count = sizeof...(Slots);
+
+    constexpr StaticProperty() = default;
+    constexpr explicit StaticProperty(T initial, Slots... slots)
+        : value_(std::move(initial)), changed_(std::move(slots)...) {}
+
+    /// Names the property for diagnostics such as slow-setter sampling.
+    constexpr StaticProperty(std::string_view bean_type, std::string_view name, T initial,
+                             Slots... slots)
+        : value_(std::move(initial)), bean_type_(bean_type), name_(name),
+          changed_(std::move(slots)...) {}
+
+    StaticProperty(const StaticProperty&) = delete;
+    StaticProperty& operator=(const StaticProperty&) = delete;
+
+    constexpr const T& get() const noexcept { return value_; }
+    constexpr operator const T&() const noexcept { return value_; }
+
+    constexpr void set(T value) {
+        if constexpr (std::equality_comparable<T>) {
+            if (value_ == value)
+                return;
+        }
+        if constexpr (listener_count == 0) {
+            value_ = std::move(value);
+        } else {
+            sampling::ScopedSetter timer(bean_type_, name_, listener_count);
+            T old = std::exchange(value_, std::move(value));
+            changed_.emit(old, value_);
+        }
+    }
+
+    constexpr StaticProperty& operator=(T value) {
+        set(std::move(value));
+        return *this;
+    }
+
+    template <std::size_t I>
+    constexpr auto& slot() noexcept {
+        return changed_.template slot<I>();
+    }
+    template <class S>
+    constexpr S& slot() noexcept {
+        return changed_.template slot<S>();
+    }
+
+    std::string_view bean_type() const noexcept { return bean_type_; }
+    std::string_view name() const noexcept { return name_; }
+
+private:
+    T value_{};
+    std::string_view bean_type_;
+    std::string_view name_;
+    [[no_unique_address]] StaticSignal<void(const T&, const T&), Slots...> changed_;
+};
+
+}  // namespace beans
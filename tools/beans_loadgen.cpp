@@ -0,0 +1,397 @@
+// Synthetic mutation workload for the beans library.
+//
+// Drives a configurable mix of property reads and writes from several threads
+// and reports throughput and latency percentiles, so a production profile can
+// be reproduced locally before upgrading.
+//
+// Build:
+//   c++ -std=c++20 -O2 -Iinclude tools/beans_loadgen.cpp -o beans_loadgen -pthread
+//
+// Example:
+//   ./beans_loadgen --threads 4 --seconds 5 --read-ratio 0.8 --listeners 3
+//                   --types int,double,string --properties 10000 --skew 0.99
+
+#include <beans/property.hpp>
+#include <beans/sampling.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    unsigned threads = 1;
+    double seconds = 3.0;
+    double read_ratio = 0.5;
+    unsigned listeners = 1;
+    unsigned listener_work = 0;
+    std::vector<std::string> types{"int"};
+    std::size_t properties = 1024;
+    double skew = 0.0;
+    std::size_t string_size = 16;
+    bool shared = false;
+    long sample_threshold_us = -1;
+    std::uint64_t seed = 1;
+};
+
+[[noreturn]] void usage(const char* argv0, int status) {
+    std::fprintf(status ? stderr : stdout,
+                 "usage: %s [options]\n"
+                 "  --threads N             worker threads (default 1)\n"
+                 "  --seconds S             run time in seconds (default 3)\n"
+                 "  --read-ratio R          fraction of operations that are reads, 0..1 (default 0.5)\n"
+                 "  --listeners N           listeners per property (default 1)\n"
+                 "  --listener-work N       busy-loop iterations per listener call (default 0)\n"
+                 "  --types LIST            comma-separated property types: int,double,string\n"
+                 "  --properties N          properties per population (default 1024)\n"
+                 "  --skew S                Zipf exponent for property selection, 0 = uniform\n"
+                 "  --string-size N         length of string values (default 16)\n"
+                 "  --shared                all threads share one population, guarded by\n"
+                 "                          per-property mutexes (default: one per thread)\n"
+                 "  --sample-threshold-us N install a slow-setter sampler with this threshold\n"
+                 "  --seed N                random seed (default 1)\n",
+                 argv0);
+    std::exit(status);
+}
+
+Options parse(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc)
+                usage(argv[0], 2);
+            return argv[++i];
+        };
+        if (arg == "--threads")
+            o.threads = static_cast<unsigned>(std::max(1L, std::strtol(value(), nullptr, 10)));
+        else if (arg == "--seconds")
+            o.seconds = std::strtod(value(), nullptr);
+        else if (arg == "--read-ratio")
+            o.read_ratio = std::clamp(std::strtod(value(), nullptr), 0.0, 1.0);
+        else if (arg == "--listeners")
+            o.listeners = static_cast<unsigned>(std::strtoul(value(), nullptr, 10));
+        else if (arg == "--listener-work")
+            o.listener_work = static_cast<unsigned>(std::strtoul(value(), nullptr, 10));
+        else if (arg == "--types") {
+            o.types.clear();
+            std::string_view list = value();
+            while (!list.empty()) {
+                const auto comma = list.find(',');
+                o.types.emplace_back(list.substr(0, comma));
+                list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+            }
+            for (const auto& t : o.types)
+                if (t != "int" && t != "double" && t != "string")
+                    usage(argv[0], 2);
+            if (o.types.empty())
+                usage(argv[0], 2);
+        } else if (arg == "--properties")
+            o.properties = std::max<std::size_t>(1, std::strtoull(value(), nullptr, 10));
+        else if (arg == "--skew")
+            o.skew = std::max(0.0, std::strtod(value(), nullptr));
+        else if (arg == "--string-size")
+            o.string_size = std::max<std::size_t>(1, std::strtoull(value(), nullptr, 10));
+        else if (arg == "--shared")
+            o.shared = true;
+        else if (arg == "--sample-threshold-us")
+            o.sample_threshold_us = std::strtol(value(), nullptr, 10);
+        else if (arg == "--seed")
+            o.seed = std::strtoull(value(), nullptr, 10);
+        else if (arg == "--help" || arg == "-h")
+            usage(argv[0], 0);
+        else
+            usage(argv[0], 2);
+    }
+    return o;
+}
+
+/// Log-linear latency histogram: 16 linear sub-buckets per power of two,
+/// giving roughly 6% relative precision from 1ns to hours.
+class Histogram {
+public:
+    void add(std::uint64_t ns) noexcept {
+        ++counts_[bucket(ns)];
+        ++total_;
+        max_ = std::max(max_, ns);
+    }
+
+    void merge(const Histogram& other) noexcept {
+        for (std::size_t i = 0; i < counts_.size(); ++i)
+            counts_[i] += other.counts_[i];
+        total_ += other.total_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    std::uint64_t count() const noexcept { return total_; }
+    std::uint64_t max() const noexcept { return max_; }
+
+    std::uint64_t percentile(double p) const noexcept {
+        if (total_ == 0)
+            return 0;
+        const auto rank = static_cast<std::uint64_t>(std::ceil(p / 100.0 * static_cast<double>(total_)));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= std::max<std::uint64_t>(rank, 1))
+                return std::min(upper_bound(i), max_);
+        }
+        return max_;
+    }
+
+private:
+    static constexpr unsigned kSubBits = 4;
+    static constexpr std::size_t kSub = 1u << kSubBits;
+
+    static std::size_t bucket(std::uint64_t v) noexcept {
+        if (v < kSub)
+            return static_cast<std::size_t>(v);
+        const unsigned exp = static_cast<unsigned>(std::bit_width(v)) - 1 - kSubBits;
+        return (exp + 1) * kSub + static_cast<std::size_t>((v >> exp) - kSub);
+    }
+
+    static std::uint64_t upper_bound(std::size_t b) noexcept {
+        if (b < kSub)
+            return b;
+        const std::size_t exp = b / kSub - 1;
+        const std::uint64_t mantissa = kSub + b % kSub;
+        return ((mantissa + 1) << exp) - 1;
+    }
+
+    std::array<std::uint64_t, (64 - kSubBits + 1) * kSub> counts_{};
+    std::uint64_t total_ = 0;
+    std::uint64_t max_ = 0;
+};
+
+/// Zipf-distributed index sampler over a precomputed CDF.
+class Selector {
+public:
+    Selector(std::size_t n, double skew) {
+        if (skew == 0.0)
+            return;
+        cdf_.resize(n);
+        double sum = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(i + 1), skew);
+            cdf_[i] = sum;
+        }
+        for (auto& c : cdf_)
+            c /= sum;
+    }
+
+    std::size_t pick(std::mt19937_64& rng, std::size_t n) const {
+        if (cdf_.empty())
+            return std::uniform_int_distribution<std::size_t>(0, n - 1)(rng);
+        const double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        const auto it = std::lower_bound(cdf_.begin(), cdf_.end(), u);
+        return std::min<std::size_t>(static_cast<std::size_t>(it - cdf_.begin()), n - 1);
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+
+// Keeps reads and listener work from being optimised away.  Each worker
+// accumulates into its own thread-local sink and publishes it once at the end,
+// so workers do not contend on a shared cache line per operation.
+std::atomic<std::uint64_t> g_sink{0};
+thread_local std::uint64_t t_sink = 0;
+
+void burn(unsigned iterations) {
+    std::uint64_t x = 0;
+    for (unsigned i = 0; i < iterations; ++i)
+        x = x * 6364136223846793005ull + i;
+    t_sink += x;
+}
+
+using AnyProperty = std::variant<beans::Property<std::int64_t>, beans::Property<double>,
+                                 beans::Property<std::string>>;
+
+struct Slot {
+    explicit Slot(std::string_view type, const Options& o) : property(make(type, o)) {
+        std::visit(
+            [&](auto& p) {
+                for (unsigned l = 0; l < o.listeners; ++l)
+                    p.subscribe([work = o.listener_work](const auto&, const auto&) { burn(work); });
+            },
+            property);
+    }
+
+    static AnyProperty make(std::string_view type, const Options& o) {
+        if (type == "int")
+            return AnyProperty(std::in_place_index<0>, "LoadBean", "int", 0);
+        if (type == "double")
+            return AnyProperty(std::in_place_index<1>, "LoadBean", "double", 0.0);
+        return AnyProperty(std::in_place_index<2>, "LoadBean", "string", std::string(o.string_size, 'a'));
+    }
+
+    AnyProperty property;
+    std::mutex mutex;
+};
+
+using Population = std::vector<std::unique_ptr<Slot>>;
+
+Population populate(const Options& o) {
+    Population pop;
+    pop.reserve(o.properties);
+    for (std::size_t i = 0; i < o.properties; ++i)
+        pop.push_back(std::make_unique<Slot>(o.types[i % o.types.size()], o));
+    return pop;
+}
+
+void read(Slot& slot) {
+    std::visit(
+        [](auto& p) {
+            using T = std::decay_t<decltype(p.get())>;
+            if constexpr (std::is_same_v<T, std::string>)
+                t_sink += static_cast<unsigned char>(p.get()[0]);
+            else
+                t_sink += static_cast<std::uint64_t>(p.get());
+        },
+        slot.property);
+}
+
+void write(Slot& slot) {
+    std::visit(
+        [](auto& p) {
+            using T = std::decay_t<decltype(p.get())>;
+            if constexpr (std::is_same_v<T, std::string>) {
+                std::string next = p.get();
+                next[0] = next[0] == 'z' ? 'a' : static_cast<char>(next[0] + 1);
+                p.set(std::move(next));
+            } else {
+                p.set(p.get() + 1);
+            }
+        },
+        slot.property);
+}
+
+struct WorkerResult {
+    Histogram reads;
+    Histogram writes;
+};
+
+WorkerResult run_worker(Population& pop, const Selector& selector, const Options& o,
+                        std::uint64_t seed, const std::atomic<bool>& stop) {
+    WorkerResult r;
+    std::mt19937_64 rng(seed);
+    std::bernoulli_distribution is_read(o.read_ratio);
+    while (!stop.load(std::memory_order_relaxed)) {
+        // Check the stop flag every batch rather than every operation.
+        for (int i = 0; i < 256; ++i) {
+            Slot& slot = *pop[selector.pick(rng, pop.size())];
+            const bool reading = is_read(rng);
+            const auto start = Clock::now();
+            {
+                std::unique_lock lock(slot.mutex, std::defer_lock);
+                if (o.shared)
+                    lock.lock();
+                if (reading)
+                    read(slot);
+                else
+                    write(slot);
+            }
+            const auto ns = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+            (reading ? r.reads : r.writes).add(ns);
+        }
+    }
+    g_sink.fetch_add(std::exchange(t_sink, 0), std::memory_order_relaxed);
+    return r;
+}
+
+void report(const char* label, const Histogram& h, double seconds) {
+    if (h.count() == 0) {
+        std::printf("%-6s        0 ops\n", label);
+        return;
+    }
+    std::printf("%-6s %10llu ops %12.0f ops/s   p50 %7llu  p90 %7llu  p99 %7llu  p99.9 %8llu  "
+                "p99.99 %8llu  max %9llu ns\n",
+                label, static_cast<unsigned long long>(h.count()),
+                static_cast<double>(h.count()) / seconds,
+                static_cast<unsigned long long>(h.percentile(50)),
+                static_cast<unsigned long long>(h.percentile(90)),
+                static_cast<unsigned long long>(h.percentile(99)),
+                static_cast<unsigned long long>(h.percentile(99.9)),
+                static_cast<unsigned long long>(h.percentile(99.99)),
+                static_cast<unsigned long long>(h.max()));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const Options o = parse(argc, argv);
+
+    std::unique_ptr<beans::sampling::SlowSetterSampler> sampler;
+    if (o.sample_threshold_us >= 0) {
+        sampler = std::make_unique<beans::sampling::SlowSetterSampler>(
+            std::chrono::microseconds(o.sample_threshold_us), 4096);
+        beans::sampling::install(sampler.get());
+    }
+
+    std::vector<Population> populations;
+    for (unsigned t = 0; t < (o.shared ? 1u : o.threads); ++t)
+        populations.push_back(populate(o));
+    const Selector selector(o.properties, o.skew);
+
+    std::string types;
+    for (const auto& t : o.types)
+        types += (types.empty() ? "" : ",") + t;
+    std::printf("threads=%u seconds=%.1f read-ratio=%.2f listeners=%u listener-work=%u types=%s "
+                "properties=%zu skew=%.2f %s\n",
+                o.threads, o.seconds, o.read_ratio, o.listeners, o.listener_work, types.c_str(),
+                o.properties, o.skew, o.shared ? "shared" : "per-thread");
+
+    std::atomic<bool> stop{false};
+    std::vector<WorkerResult> results(o.threads);
+    std::vector<std::thread> workers;
+    const auto start = Clock::now();
+    for (unsigned t = 0; t < o.threads; ++t) {
+        workers.emplace_back([&, t] {
+            results[t] = run_worker(populations[o.shared ? 0 : t], selector, o, o.seed + t, stop);
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(o.seconds));
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& w : workers)
+        w.join();
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    WorkerResult total;
+    for (const auto& r : results) {
+        total.reads.merge(r.reads);
+        total.writes.merge(r.writes);
+    }
+    Histogram all = total.reads;
+    all.merge(total.writes);
+    report("read", total.reads, elapsed);
+    report("write", total.writes, elapsed);
+    report("total", all, elapsed);
+
+    if (sampler) {
+        beans::sampling::install(nullptr);
+        std::vector<beans::sampling::SetterSample> samples;
+        sampler->drain(samples);
+        std::printf("slow setters (>= %ld us): %llu recorded, %zu retained\n", o.sample_threshold_us,
+                    static_cast<unsigned long long>(sampler->recorded()), samples.size());
+    }
+    return 0;
+}
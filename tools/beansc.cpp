@@ -0,0 +1,699 @@
+// beansc: compiles a bean schema into a C++ header.
+//
+// For each bean the generated class has padding-minimising storage, typed
+// accessors, change notification, a binary codec and a constexpr
+// beans::BeanDescriptor, all written out per type so no generic template
+// machinery has to be instantiated.  Generated beans are Reflectable and work
+// with descriptor_of, BeanTable and the rest of the library.
+//
+// Build:
+//   c++ -std=c++20 -O2 tools/beansc.cpp -o beansc
+//
+// Usage:
+//   beansc schema.beans -o schema.hpp
+//
+// Schema syntax:
+//
+//   // Comments run to the end of the line.
+//   namespace app.trading;
+//
+//   bean Trade {
+//       string symbol = 1;
+//       double price = 2 [hot];
+//       int32  qty = 3 [default = 100];
+//       bool   open [hot, default = true];
+//   }
+//
+// Types: bool, int8, int16, int32, int64, uint8, uint16, uint32, uint64,
+// float, double, string.  `= N` assigns a field number for wire formats that
+// tag fields (consecutive numbers are assigned when omitted); field numbers
+// are unique within a bean.
+//
+// Codec format: fields in declaration order; numbers and bools as their
+// little-endian object representation, strings as a varint length followed by
+// the bytes.
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct Type {
+    std::string_view idl;
+    std::string_view cpp;
+    std::string_view kind;  // beans::FieldKind enumerator
+    unsigned align;         // Used only to order storage.
+    unsigned fixed_size;    // Encoded size; 0 for strings.
+};
+
+constexpr Type kTypes[] = {
+    {"bool", "bool", "Bool", 1, 1},
+    {"int8", "std::int8_t", "Int8", 1, 1},
+    {"int16", "std::int16_t", "Int16", 2, 2},
+    {"int32", "std::int32_t", "Int32", 4, 4},
+    {"int64", "std::int64_t", "Int64", 8, 8},
+    {"uint8", "std::uint8_t", "UInt8", 1, 1},
+    {"uint16", "std::uint16_t", "UInt16", 2, 2},
+    {"uint32", "std::uint32_t", "UInt32", 4, 4},
+    {"uint64", "std::uint64_t", "UInt64", 8, 8},
+    {"float", "float", "Float", 4, 4},
+    {"double", "double", "Double", 8, 8},
+    {"string", "std::string", "String", 8, 0},
+};
+
+const Type* find_type(std::string_view name) {
+    for (const Type& t : kTypes)
+        if (t.idl == name)
+            return &t;
+    return nullptr;
+}
+
+struct Field {
+    std::string name;
+    const Type* type = nullptr;
+    std::uint32_t number = 0;
+    bool hot = false;
+    std::string default_value;  // C++ initializer text, empty for value-init.
+    int line = 0;
+};
+
+struct BeanDef {
+    std::string name;
+    std::vector<Field> fields;
+    int line = 0;
+};
+
+struct Schema {
+    std::vector<std::string> namespace_parts;
+    std::vector<BeanDef> beans;
+};
+
+// --- Lexer ----------------------------------------------------------------
+
+enum class Tok { Ident, Number, String, Punct, End };
+
+struct Token {
+    Tok kind;
+    std::string text;
+    int line;
+};
+
+class Lexer {
+public:
+    Lexer(std::string_view src, std::string file) : src_(src), file_(std::move(file)) {}
+
+    [[noreturn]] void fail(int line, const std::string& message) const {
+        std::cerr << file_ << ':' << line << ": error: " << message << '\n';
+        std::exit(1);
+    }
+
+    std::vector<Token> tokenize() {
+        std::vector<Token> out;
+        while (true) {
+            skip_space();
+            if (pos_ >= src_.size()) {
+                out.push_back({Tok::End, "", line_});
+                return out;
+            }
+            const char c = src_[pos_];
+            const std::size_t start = pos_;
+            if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                while (pos_ < src_.size() &&
+                       (std::isalnum(static_cast<unsigned char>(src_[pos_])) || src_[pos_] == '_'))
+                    ++pos_;
+                out.push_back({Tok::Ident, std::string(src_.substr(start, pos_ - start)), line_});
+            } else if (std::isdigit(static_cast<unsigned char>(c)) || c == '-' || c == '+') {
+                ++pos_;
+                while (pos_ < src_.size() &&
+                       (std::isalnum(static_cast<unsigned char>(src_[pos_])) || src_[pos_] == '.' ||
+                        ((src_[pos_] == '-' || src_[pos_] == '+') &&
+                         (src_[pos_ - 1] == 'e' || src_[pos_ - 1] == 'E'))))
+                    ++pos_;
+                out.push_back({Tok::Number, std::string(src_.substr(start, pos_ - start)), line_});
+            } else if (c == '"') {
+                ++pos_;
+                while (pos_ < src_.size() && src_[pos_] != '"') {
+                    if (src_[pos_] == '\n')
+                        fail(line_, "unterminated string");
+                    if (src_[pos_] == '\\')
+                        ++pos_;
+                    ++pos_;
+                }
+                if (pos_ >= src_.size())
+                    fail(line_, "unterminated string");
+                ++pos_;
+                out.push_back({Tok::String, std::string(src_.substr(start, pos_ - start)), line_});
+            } else if (std::string_view("{}[]=;,.").find(c) != std::string_view::npos) {
+                ++pos_;
+                out.push_back({Tok::Punct, std::string(1, c), line_});
+            } else {
+                fail(line_, std::string("unexpected character '") + c + "'");
+            }
+        }
+    }
+
+private:
+    void skip_space() {
+        while (pos_ < src_.size()) {
+            if (src_[pos_] == '\n') {
+                ++line_;
+                ++pos_;
+            } else if (std::isspace(static_cast<unsigned char>(src_[pos_]))) {
+                ++pos_;
+            } else if (src_.substr(pos_, 2) == "//") {
+                while (pos_ < src_.size() && src_[pos_] != '\n')
+                    ++pos_;
+            } else {
+                return;
+            }
+        }
+    }
+
+    std::string_view src_;
+    std::string file_;
+    std::size_t pos_ = 0;
+    int line_ = 1;
+};
+
+// --- Parser ---------------------------------------------------------------
+
+// C++20 keywords and alternative operator tokens; no name in the schema may
+// be one.
+const std::set<std::string, std::less<>> kKeywords = {
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break",
+    "case", "catch", "char", "char8_t", "char16_t", "char32_t", "class", "co_await", "co_return",
+    "co_yield", "compl", "concept", "const", "consteval", "constexpr", "constinit", "const_cast",
+    "continue", "decltype", "default", "delete", "do", "double", "dynamic_cast", "else", "enum",
+    "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if", "inline",
+    "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq", "nullptr",
+    "operator", "or", "or_eq", "private", "protected", "public", "register", "reinterpret_cast",
+    "requires", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast",
+    "struct", "switch", "template", "this", "thread_local", "throw", "true", "try", "typedef",
+    "typeid", "typename", "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t",
+    "while", "xor", "xor_eq"};
+
+// Members of the generated class, which its fields would clash with.  A bean
+// cannot be named after one of them either, since a member may not share
+// its class's name.
+const std::set<std::string, std::less<>> kMembers = {
+    "Field", "Listener", "subscribe", "unsubscribe", "encoded_size", "encode", "decode",
+    "beans_traits", "changed", "listeners_", "field_names_"};
+
+class Parser {
+public:
+    Parser(const Lexer& lexer, std::vector<Token> tokens)
+        : lexer_(lexer), tokens_(std::move(tokens)) {}
+
+    Schema parse() {
+        Schema schema;
+        if (peek_ident("namespace")) {
+            next();
+            do {
+                const int line = cur().line;
+                schema.namespace_parts.push_back(expect_ident("namespace name"));
+                if (kKeywords.count(schema.namespace_parts.back()))
+                    lexer_.fail(line, "'" + schema.namespace_parts.back() +
+                                          "' cannot be used as a namespace name");
+            } while (accept("."));
+            expect(";");
+        }
+        std::set<std::string, std::less<>> names;
+        while (cur().kind != Tok::End) {
+            if (!peek_ident("bean"))
+                fail("expected 'bean'");
+            BeanDef bean = parse_bean();
+            if (!names.insert(bean.name).second)
+                lexer_.fail(bean.line, "duplicate bean '" + bean.name + "'");
+            schema.beans.push_back(std::move(bean));
+        }
+        return schema;
+    }
+
+private:
+    BeanDef parse_bean() {
+        BeanDef bean;
+        bean.line = next().line;
+        bean.name = expect_ident("bean name");
+        if (kKeywords.count(bean.name) || kMembers.count(bean.name))
+            lexer_.fail(bean.line, "'" + bean.name + "' cannot be used as a bean name");
+        expect("{");
+        std::set<std::string, std::less<>> names;
+        std::set<std::uint32_t> numbers;
+        std::uint32_t next_number = 1;
+        while (!accept("}")) {
+            Field f;
+            f.line = cur().line;
+            const std::string type = expect_ident("field type");
+            f.type = find_type(type);
+            if (!f.type)
+                lexer_.fail(f.line, "unknown type '" + type + "'");
+            f.name = expect_ident("field name");
+            if (kKeywords.count(f.name) || kMembers.count(f.name))
+                lexer_.fail(f.line, "'" + f.name + "' cannot be used as a field name");
+            if (!names.insert(f.name).second)
+                lexer_.fail(f.line, "duplicate field '" + f.name + "'");
+            f.number = next_number;
+            if (accept("=")) {
+                const Token& t = next();
+                char* end = nullptr;
+                const unsigned long n = std::strtoul(t.text.c_str(), &end, 10);
+                if (t.kind != Tok::Number || *end || n == 0 || n > 0x1fffffff)
+                    lexer_.fail(t.line, "field number must be between 1 and 536870911");
+                f.number = static_cast<std::uint32_t>(n);
+            }
+            if (!numbers.insert(f.number).second)
+                lexer_.fail(f.line, "duplicate field number " + std::to_string(f.number));
+            next_number = f.number + 1;
+            if (accept("[")) {
+                do {
+                    const std::string option = expect_ident("option");
+                    if (option == "hot") {
+                        f.hot = true;
+                    } else if (option == "default") {
+                        expect("=");
+                        f.default_value = literal(f);
+                    } else {
+                        lexer_.fail(f.line, "unknown option '" + option + "'");
+                    }
+                } while (accept(","));
+                expect("]");
+            }
+            expect(";");
+            bean.fields.push_back(std::move(f));
+        }
+        return bean;
+    }
+
+    std::string literal(const Field& f) {
+        const Token& t = next();
+        const std::string_view idl = f.type->idl;
+        if (idl == "string") {
+            if (t.kind != Tok::String)
+                lexer_.fail(t.line, "default for a string field must be a string");
+            return t.text;
+        }
+        if (idl == "bool") {
+            if (t.kind != Tok::Ident || (t.text != "true" && t.text != "false"))
+                lexer_.fail(t.line, "default for a bool field must be true or false");
+            return t.text;
+        }
+        if (t.kind != Tok::Number)
+            lexer_.fail(t.line, "default for a numeric field must be a number");
+        if (idl != "float" && idl != "double")
+            return integer_literal(t, idl);
+        return floating_literal(t, idl);
+    }
+
+    /// Checks a floating-point default is a finite number the field type can
+    /// represent and returns it as a C++ literal of that type.
+    std::string floating_literal(const Token& t, std::string_view idl) {
+        const char* text = t.text.c_str();
+        char* end = nullptr;
+        errno = 0;
+        const double v = idl == "float" ? std::strtof(text, &end) : std::strtod(text, &end);
+        if (*end || end == text || std::isnan(v))
+            lexer_.fail(t.line, "default for a floating-point field must be a number");
+        if (errno == ERANGE || std::isinf(v))
+            lexer_.fail(t.line, "default " + t.text + " is out of range for " + std::string(idl));
+        // An integer is written as a floating-point literal, so it is neither
+        // narrowed nor, in hex, read as more digits by the 'f' suffix.
+        std::string literal = t.text;
+        const bool hex = literal.find_first_of("xX") != std::string::npos;
+        if (hex && literal.find_first_of("pP") == std::string::npos)
+            literal += "p0";
+        else if (!hex && literal.find_first_of(".eE") == std::string::npos)
+            literal += ".0";
+        return idl == "float" ? literal + "f" : literal;
+    }
+
+    /// Checks an integer default against the field type's range and returns
+    /// it as a C++ literal of a type that initialises the field without
+    /// narrowing.
+    std::string integer_literal(const Token& t, std::string_view idl) {
+        const bool is_unsigned = idl[0] == 'u';
+        const int bits = std::atoi(std::string(idl.substr(is_unsigned ? 4 : 3)).c_str());
+        const char* text = t.text.c_str();
+        char* end = nullptr;
+        errno = 0;
+        if (is_unsigned) {
+            if (t.text[0] == '-')
+                lexer_.fail(t.line, "default " + t.text + " is negative for " + std::string(idl));
+            const unsigned long long v = std::strtoull(text, &end, 0);
+            const unsigned long long max = bits == 64 ? ~0ull : (1ull << bits) - 1;
+            if (*end || end == text)
+                lexer_.fail(t.line, "default for an integer field must be an integer");
+            if (errno == ERANGE || v > max)
+                lexer_.fail(t.line, "default " + t.text + " is out of range for " + std::string(idl));
+            return std::to_string(v) + "u";
+        }
+        const long long v = std::strtoll(text, &end, 0);
+        const long long max = bits == 64 ? 0x7fffffffffffffffll : (1ll << (bits - 1)) - 1;
+        if (*end || end == text)
+            lexer_.fail(t.line, "default for an integer field must be an integer");
+        if (errno == ERANGE || v > max || v < -max - 1)
+            lexer_.fail(t.line, "default " + t.text + " is out of range for " + std::string(idl));
+        // The most negative int64 has no literal of its own.
+        return bits == 64 && v == -max - 1 ? "(" + std::to_string(v + 1) + " - 1)" : std::to_string(v);
+    }
+
+    const Token& cur() const { return tokens_[pos_]; }
+    const Token& next() { return tokens_[pos_ < tokens_.size() - 1 ? pos_++ : pos_]; }
+
+    bool peek_ident(std::string_view word) const {
+        return cur().kind == Tok::Ident && cur().text == word;
+    }
+
+    bool accept(std::string_view punct) {
+        if (cur().kind == Tok::Punct && cur().text == punct) {
+            next();
+            return true;
+        }
+        return false;
+    }
+
+    void expect(std::string_view punct) {
+        if (!accept(punct))
+            fail("expected '" + std::string(punct) + "'");
+    }
+
+    std::string expect_ident(const char* what) {
+        if (cur().kind != Tok::Ident)
+            fail(std::string("expected ") + what);
+        return next().text;
+    }
+
+    [[noreturn]] void fail(const std::string& message) const {
+        lexer_.fail(cur().line,
+                    message + (cur().kind == Tok::End ? " at end of file" : ", got '" + cur().text + "'"));
+    }
+
+    const Lexer& lexer_;
+    std::vector<Token> tokens_;
+    std::size_t pos_ = 0;
+};
+
+// --- Generator ------------------------------------------------------------
+
+std::uint64_t name_hash(std::string_view name) {
+    // Must match beans::name_hash (FNV-1a, 64-bit).
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    for (const char c : name) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+std::string hex(std::uint64_t v) {
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "0x%016llxull", static_cast<unsigned long long>(v));
+    return buf;
+}
+
+/// Hot fields first, then by decreasing alignment, declaration order breaking
+/// ties; the same rule as beans::Bean.
+std::vector<const Field*> storage_order(const BeanDef& bean) {
+    std::vector<const Field*> order;
+    for (const Field& f : bean.fields)
+        order.push_back(&f);
+    std::stable_sort(order.begin(), order.end(), [](const Field* a, const Field* b) {
+        if (a->hot != b->hot)
+            return a->hot;
+        return a->type->align > b->type->align;
+    });
+    return order;
+}
+
+bool by_value(const Field& f) { return f.type->idl != "string"; }
+
+void emit_bean(std::ostream& o, const BeanDef& bean, const std::string& qualified) {
+    const std::string& B = bean.name;
+    const std::size_t n = bean.fields.size();
+
+    o << "class " << B << " {\npublic:\n";
+    o << "    enum class Field : std::uint16_t {\n";
+    for (const Field& f : bean.fields)
+        o << "        " << f.name << ",\n";
+    o << "    };\n";
+    o << "    using Listener = beans::Function<void(const " << B << "&, Field)>;\n\n";
+
+    o << "    " << B << "() = default;\n";
+    if (n > 0) {
+        o << "    " << (n == 1 ? "explicit " : "") << B << "(";
+        for (std::size_t i = 0; i < n; ++i)
+            o << (i ? ", " : "") << bean.fields[i].type->cpp << ' ' << bean.fields[i].name;
+        o << ")\n        : ";
+        bool first = true;
+        for (const Field* f : storage_order(bean)) {
+            o << (first ? "" : ", ") << f->name << "_(" << (by_value(*f) ? f->name : "std::move(" + f->name + ")")
+              << ')';
+            first = false;
+        }
+        o << " {}\n";
+    }
+    o << '\n';
+
+    for (const Field& f : bean.fields) {
+        const std::string_view t = f.type->cpp;
+        if (by_value(f))
+            o << "    " << t << ' ' << f.name << "() const noexcept { return " << f.name << "_; }\n";
+        else
+            o << "    const " << t << "& " << f.name << "() const noexcept { return " << f.name << "_; }\n";
+        o << "    void set_" << f.name << '(' << t << " value) {\n"
+          << "        if (" << f.name << "_ == value)\n"
+          << "            return;\n"
+          << "        " << f.name << "_ = " << (by_value(f) ? "value" : "std::move(value)") << ";\n"
+          << "        changed(Field::" << f.name << ");\n"
+          << "    }\n";
+    }
+    if (n > 0)
+        o << '\n';
+
+    o << "    /// Calls `listener(bean, field)` after each change made through a setter.\n"
+      << "    beans::ListenerId subscribe(Listener listener) {\n"
+      << "        return listeners_.subscribe(std::move(listener));\n"
+      << "    }\n"
+      << "    bool unsubscribe(beans::ListenerId id) { return listeners_.unsubscribe(id); }\n\n";
+
+    unsigned fixed = 0;
+    std::vector<std::string> terms;
+    for (const Field& f : bean.fields) {
+        fixed += f.type->fixed_size;
+        if (!f.type->fixed_size)
+            terms.push_back("beans::detail::varint_size(" + f.name + "_.size()) + " + f.name + "_.size()");
+    }
+    if (fixed || terms.empty())
+        terms.insert(terms.begin(), std::to_string(fixed));
+    o << "    std::size_t encoded_size() const noexcept {\n"
+      << "        return ";
+    for (std::size_t i = 0; i < terms.size(); ++i)
+        o << (i ? "\n            + " : "") << terms[i];
+    o << ";\n    }\n\n";
+
+    o << "    /// Appends the binary encoding of this bean to `out`.\n"
+      << "    void encode(std::string& out) const {\n"
+      << "        out.reserve(out.size() + encoded_size());\n";
+    for (const Field& f : bean.fields)
+        o << "        beans::detail::" << (f.type->fixed_size ? "put_fixed" : "put_bytes") << "(out, "
+          << f.name << "_);\n";
+    o << "    }\n\n";
+
+    o << "    /// Decodes a bean from the front of `in` and consumes it.  Listeners are\n"
+      << "    /// not notified.  Returns false if `in` is truncated.\n"
+      << "    bool decode(std::string_view& in) {\n";
+    if (n == 0) {
+        o << "        (void)in;\n        return true;\n";
+    } else {
+        o << "        return ";
+        for (std::size_t i = 0; i < n; ++i) {
+            const Field& f = bean.fields[i];
+            o << (i ? "\n            && " : "") << "beans::detail::"
+              << (f.type->fixed_size ? "get_fixed" : "get_bytes") << "(in, " << f.name << "_)";
+        }
+        o << ";\n";
+    }
+    o << "    }\n\n";
+
+    if (n == 0) {
+        o << "    friend bool operator==(const " << B << "&, const " << B << "&) noexcept { return true; }\n\n";
+    } else {
+        o << "    friend bool operator==(const " << B << "& a, const " << B << "& b) noexcept {\n"
+          << "        return ";
+        for (std::size_t i = 0; i < n; ++i)
+            o << (i ? "\n            && " : "") << "a." << bean.fields[i].name << "_ == b."
+              << bean.fields[i].name << '_';
+        o << ";\n    }\n\n";
+    }
+
+    o << "    struct beans_traits;\n\nprivate:\n";
+    o << "    static constexpr std::string_view field_names_[] = {";
+    for (std::size_t i = 0; i < n; ++i)
+        o << (i ? ", " : "") << '"' << bean.fields[i].name << '"';
+    o << (n == 0 ? "\"\"" : "") << "};\n\n";
+    o << "    void changed([[maybe_unused]] Field field) {\n"
+      << "        if (listeners_.empty())\n"
+      << "            return;\n"
+      << "        beans::sampling::ScopedSetter timer(\"" << qualified << "\",\n"
+      << "                                            field_names_[static_cast<std::size_t>(field)],\n"
+      << "                                            listeners_.size());\n"
+      << "        listeners_.notify(*this, field);\n"
+      << "    }\n\n";
+
+    o << "    // Storage order: hot fields first, then by decreasing alignment.\n";
+    for (const Field* f : storage_order(bean))
+        o << "    " << f->type->cpp << ' ' << f->name << "_{" << f->default_value << "};\n";
+    o << "    beans::detail::LazyListenerList<const " << B << "&, Field> listeners_;\n";
+    o << "};\n\n";
+
+    // Reflection traits and descriptor.
+    o << "struct " << B << "::beans_traits {\n"
+      << "    static constexpr std::size_t size = " << n << ";\n"
+      << "    static constexpr std::string_view name = \"" << qualified << "\";\n\n"
+      << "    template <std::size_t I>\n"
+      << "    static constexpr std::string_view field_name = " << B << "::field_names_[I];\n\n"
+      << "    template <std::size_t I>\n"
+      << "    static constexpr auto& get(" << B << "& bean) noexcept {\n";
+    if (n == 0) {
+        o << "        static_assert(I != I, \"" << B << " has no fields\");\n"
+          << "        return bean;\n";
+    }
+    for (std::size_t i = 0; i < n; ++i)
+        o << "        " << (i ? "} else if" : "if") << " constexpr (I == " << i << ") {\n"
+          << "            return bean." << bean.fields[i].name << "_;\n";
+    if (n > 0)
+        o << "        }\n";
+    o << "    }\n"
+      << "    template <std::size_t I>\n"
+      << "    static constexpr const auto& get(const " << B << "& bean) noexcept {\n"
+      << "        return get<I>(const_cast<" << B << "&>(bean));\n"
+      << "    }\n\n";
+
+    for (const Field& f : bean.fields)
+        o << "    static void* address_" << f.name << "(void* bean) noexcept {\n"
+          << "        return &static_cast<" << B << "*>(bean)->" << f.name << "_;\n"
+          << "    }\n";
+    o << "    static constexpr std::array<beans::FieldDescriptor, " << n << "> fields{{\n";
+    for (std::size_t i = 0; i < n; ++i) {
+        const Field& f = bean.fields[i];
+        o << "        {\"" << f.name << "\", " << hex(name_hash(f.name)) << ", beans::FieldKind::"
+          << f.type->kind << ", " << i << ",\n"
+          << "         sizeof(" << f.type->cpp << "), alignof(" << f.type->cpp << "), &address_"
+          << f.name << ", " << f.number << "},\n";
+    }
+    o << "    }};\n";
+
+    std::vector<std::size_t> by_hash(n);
+    for (std::size_t i = 0; i < n; ++i)
+        by_hash[i] = i;
+    std::stable_sort(by_hash.begin(), by_hash.end(), [&](std::size_t a, std::size_t b) {
+        return name_hash(bean.fields[a].name) < name_hash(bean.fields[b].name);
+    });
+    o << "    static constexpr std::array<std::uint16_t, " << n << "> by_hash{";
+    for (std::size_t i = 0; i < n; ++i)
+        o << (i ? ", " : "") << by_hash[i];
+    o << "};\n"
+      << "    static constexpr beans::BeanDescriptor descriptor{name, fields, sizeof(" << B
+      << "), alignof(" << B << "),\n"
+      << "                                                    by_hash};\n"
+      << "};\n";
+}
+
+void emit(std::ostream& o, const Schema& schema, const std::string& input) {
+    std::string ns, qualifier;
+    for (const auto& part : schema.namespace_parts) {
+        ns += (ns.empty() ? "" : "::") + part;
+        qualifier += part + "::";
+    }
+
+    o << "// Generated by beansc from " << input << ". Do not edit.\n"
+      << "#pragma once\n\n"
+      << "#include <beans/descriptor.hpp>\n"
+      << "#include <beans/detail/listeners.hpp>\n"
+      << "#include <beans/detail/wire.hpp>\n"
+      << "#include <beans/function.hpp>\n"
+      << "#include <beans/reflect.hpp>\n"
+      << "#include <beans/sampling.hpp>\n\n"
+      << "#include <array>\n"
+      << "#include <bit>\n"
+      << "#include <cstddef>\n"
+      << "#include <cstdint>\n"
+      << "#include <string>\n"
+      << "#include <string_view>\n"
+      << "#include <utility>\n\n"
+      << "static_assert(std::endian::native == std::endian::little,\n"
+      << "              \"beansc codecs assume a little-endian host\");\n\n";
+    if (!ns.empty())
+        o << "namespace " << ns << " {\n\n";
+    for (std::size_t i = 0; i < schema.beans.size(); ++i) {
+        if (i)
+            o << '\n';
+        emit_bean(o, schema.beans[i], qualifier + schema.beans[i].name);
+    }
+    if (!ns.empty())
+        o << "\n}  // namespace " << ns << '\n';
+}
+
+[[noreturn]] void usage(int status) {
+    (status ? std::cerr : std::cout) << "usage: beansc <schema> [-o <header>]\n";
+    std::exit(status);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string input, output;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "-o" && i + 1 < argc)
+            output = argv[++i];
+        else if (arg == "-h" || arg == "--help")
+            usage(0);
+        else if (input.empty() && !arg.starts_with("-"))
+            input = arg;
+        else
+            usage(2);
+    }
+    if (input.empty())
+        usage(2);
+
+    std::ifstream in(input, std::ios::binary);
+    if (!in) {
+        std::cerr << "beansc: cannot open " << input << '\n';
+        return 1;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string source = buffer.str();
+
+    Lexer lexer(source, input);
+    Parser parser(lexer, lexer.tokenize());
+    const Schema schema = parser.parse();
+
+    std::ostringstream generated;
+    const std::size_t slash = input.find_last_of("/\\");
+    emit(generated, schema, slash == std::string::npos ? input : input.substr(slash + 1));
+
+    if (output.empty()) {
+        std::cout << generated.str();
+        return 0;
+    }
+    std::ofstream out(output, std::ios::binary);
+    out << generated.str();
+    if (!out) {
+        std::cerr << "beansc: cannot write " << output << '\n';
+        return 1;
+    }
+    return 0;
+}